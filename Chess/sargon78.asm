@@ -1351,10 +1351,12 @@ NX6:    EXX                     ; Restore regs.
 ; CALLS:      --  ATTACK
 ;                 XCHNG
 ;                 LIMIT
+;                 CNTNOD
 ;
 ; ARGUMENTS:  --  None
 ;***********************************************************
-POINTS: XOR     a             ; Zero out variables
+POINTS: CALL    CNTNOD          ; Count evaluated positions
+        XOR     a             ; Zero out variables
         LD      (MTRL),a
         LD      (BRDC),a
         LD      (PTSL),a
@@ -1779,6 +1781,7 @@ EV10:   CALL    UNMOVE          ; Restore board array
 ;                 the techniques of alpha-beta pruning.
 ;
 ; CALLED BY:  --  CPTRMV
+;                 PNDPLY
 ;
 ; CALLS:      --  PINFND
 ;                 POINTS
@@ -1786,10 +1789,15 @@ EV10:   CALL    UNMOVE          ; Restore board array
 ;                 SORTM
 ;                 ASCEND
 ;                 UNMOVE
+;                 PNDPOL
+;                 PVSAVE
 ;
 ; ARGUMENTS:  --  None
 ;***********************************************************
-FNDMOV: LD      a,(MOVENO)      ; Current move number
+FNDMOV: LD      hl,0            ; No predicted reply yet
+        LD      (PVREPLY),hl
+        LD      (PVTMP),hl
+        LD      a,(MOVENO)      ; Current move number
         CP      1             ; First move ?
         CALL    Z,BOOK          ; Yes - execute book opening
         XOR     a             ; Initialize ply number to zero
@@ -1819,7 +1827,8 @@ back05: LD      (hl),a
         LD      (BC0),a         ; Save
         LD      a,(MTRL)        ; Get material count
         LD      (MV0),a         ; Save
-FM5:    LD      hl,NPLY         ; Address of ply counter
+FM5:    CALL    PNDPOL          ; Poll keyboard if pondering
+        LD      hl,NPLY         ; Address of ply counter
         INC     (hl)            ; Increment ply count
         XOR     a             ; Initialize mate flag
         LD      (MATEF),a
@@ -1922,6 +1931,7 @@ FM37:
         JP      C,FM15          ; Jump if less than
         JP      Z,FM15          ; Jump if equal
         LD      (hl),a          ; Save as new score 1 ply above
+        CALL    PVSAVE          ; Track predicted reply
         LD      a,(NPLY)        ; Get current ply counter
         CP      1             ; At top of tree ?
         JP      NZ,FM15         ; No - jump
@@ -2115,6 +2125,7 @@ BLANKR:  DB      '[',1CH,']'     ; Control-\
 P_PEP:   DB      "pxpep"
 INVAL1:  DB      "invalid move"
 INVAL2:  DB      "try again"
+PNDMSG:  DB      "ponder on your time (y/n)?"
 
 
 ;*******************************************************
@@ -2210,10 +2221,11 @@ LINECT:  DB      0               ; Current line number
 ; CALLS:      --  INTERR
 ;                 INITBD
 ;                 DSPBRD
-;                 CPTRMV
-;                 PLYRMV
+;                 PNDCPT
+;                 PNDPLY
 ;                 TBCPCL
 ;                 PGIFND
+;                 EPDRUN
 ;
 ; MACRO CALLS:    CrtClear
 ;                 CARRET
@@ -2225,6 +2237,9 @@ LINECT:  DB      0               ; Current line number
         ORG     START+1A00H     ; Above the move logic
 
 DRIVER: LD      sp,STACK        ; Set stack pointer
+	ld	a,(5DH)		; File name on the command line ?
+	cp	' '
+	jp	nz,EPDRUN	; Yes - run the EPD test suite
 	xor	a		; set (time) = 0
 	ld	(time),a
 	ld	h,a
@@ -2262,6 +2277,8 @@ DRIV01:
 	EXIT
 ;       JP      Z,ANALYS        ; If so then jump to ANALYSing a position
 GO:
+	ld	hl,0		; No predicted reply from a previous game
+	ld	(PVREPLY),hl
 	ld	de,LoadGameMsg	; Ask 'load saved game?'
 	call	show_string_de
 	ld	c,BDOS_Console_Input
@@ -2323,34 +2340,34 @@ DRIV04:
 	PRTBLK	SPACE,14
 	jr	skip
 domove:
-	call	GetStartTime
-        CALL    CPTRMV          ; Make and write computers move
+	call	PNDSTA
+        CALL    PNDCPT          ; Make and write computers move
 	call	GetStopTime
-        PRTBLK  SPACE,1         ; Output a space
+        PRTBLK  PNDMRK,1        ; Output a space or ponder hit mark
 	call	PrintLapseTime
 skip:
         PRTBLK  SPACE,1         ; Output a space
 	call	GetStartTime
-        CALL    PLYRMV          ; Accept and make players move
-	call	GetStopTime
+        CALL    PNDPLY          ; Accept and make players move
+	call	PNDSTP
         PRTBLK  SPACE,1         ; Output a space
 	call	PrintLapseTime
         CARRET                  ; New line
         JR      DR0C            ; Jump
 DR08:   
 	call	GetStartTime
-	CALL    PLYRMV          ; Accept and make players move
-	call	GetStopTime
+	CALL    PNDPLY          ; Accept and make players move
+	call	PNDSTP
         PRTBLK  SPACE,1         ; Output a space
 	call	PrintLapseTime
         PRTBLK  SPACE,1         ; Output a space
         CALL    PGIFND          ; New page if needed
         CP      1               ; Was page turned ?
         CALL    Z,TBCPCL        ; Yes - Tab to computers column
-	call	GetStartTime
-        CALL    CPTRMV          ; Make and write computers move
+	call	PNDSTA
+        CALL    PNDCPT          ; Make and write computers move
 	call	GetStopTime
-        PRTBLK  SPACE,1         ; Output a space
+        PRTBLK  PNDMRK,1        ; Output a space or ponder hit mark
 	call	PrintLapseTime
         CARRET                  ; New line
 DR0C:   LD      hl,MVENUM+2     ; Addr of 3rd char of move
@@ -2382,7 +2399,7 @@ DR14:   LD      hl,MOVENO       ; Hexadecimal move number
 ; INTERROGATION FOR PLY & COLOR
 ;***********************************************************
 ; FUNCTION:   --  To query the player for his choice of ply
-;                 depth and color.
+;                 depth, color and pondering.
 ;
 ; CALLED BY:  --  DRIVER
 ;
@@ -2419,7 +2436,15 @@ IN04:   LD      a,80H           ; Set computers color to black
         LD      de,TITLE4+9
         LD      bc,6
         LDIR
-IN08:   PRTLIN  PLYDEP,23       ; Request depth of search
+IN08:   PRTLIN  PNDMSG,26       ; Request pondering choice
+        CALL    CHARTR          ; Accept response
+        CARRET                  ; New line
+        LD      hl,PONDON       ; Pondering is on
+        LD      (hl),1
+        CP      'N'             ; Unless the player declines
+        JR      NZ,IN0C
+        LD      (hl),0
+IN0C:   PRTLIN  PLYDEP,23       ; Request depth of search
         CALL    CHARTR          ; Accept response
         CARRET                  ; New line
         LD      hl,PLYMAX       ; Address of ply depth variabl
@@ -2439,7 +2464,7 @@ IN08:   PRTLIN  PLYDEP,23       ; Request depth of search
 ;                 and the display of that move on the board
 ;                 and in the move list.
 ;
-; CALLED BY:  --  DRIVER
+; CALLED BY:  --  PNDCPT
 ;
 ; CALLS:      --  FNDMOV
 ;                 FCDMAT
@@ -2454,7 +2479,7 @@ IN08:   PRTLIN  PLYDEP,23       ; Request depth of search
 ; ARGUMENTS:  --  None
 ;***********************************************************
 CPTRMV: CALL    FNDMOV          ; Select best move
-        LD      hl,(BESTM)      ; Move list pointer variable
+CPTRM1: LD      hl,(BESTM)      ; Move list pointer variable
         LD      (MLPTRJ),hl     ; Pointer to move data
         LD      a,(SCORE+1)     ; To check for mates
         CP      1               ; Mate against computer ?
@@ -2680,7 +2705,7 @@ BITASN: SUB     a             ; Get ready for division
 ;                 allows player to resign the game by
 ;                 entering a control-R.
 ;
-; CALLED BY:  --  DRIVER
+; CALLED BY:  --  PNDPLY
 ;
 ; CALLS:      --  CHARTR
 ;                 ASNTBI
@@ -2773,6 +2798,7 @@ AT04:   LD      b,a             ; Invalid flag
 ; FUNCTION:   --  To check a players move for validity.
 ;
 ; CALLED BY:  --  PLYRMV
+;                 PNDPLY
 ;
 ; CALLS:      --  GENMOV
 ;                 MOVE
@@ -2847,6 +2873,8 @@ VA10:   LD      a,1             ; Set flag for invalid move
 ;***********************************************************
 CHARTR: 
         push    hl
+        call    PNDGET          ; Typed ahead while pondering ?
+        jr      nz, CHARTR2     ; Yes - already echoed and folded
 CHARTR1: 
 	call	GetTime
         ld      c, BDOS_Console_Direct
@@ -2854,12 +2882,21 @@ CHARTR1:
         call    BDOS            ; Read key from keyboard (if none we will get 0)
         cp      0
         jr      z, CHARTR1 
+        call    CHFOLD          ; Echo and fold to upper case
+CHARTR2:
+        pop     hl
+        RET                     ; Return
+;
+;       Echo the character in A and fold it to upper case
+;       (CR, LF and backspace are returned untouched)
+;
+CHFOLD:
         CP      0DH             ; Carriage return ?
-        jr      Z, CHARTR2      ; Yes - return
+        RET     Z               ; Yes - return
         CP      0AH             ; Line feed ?
-        jr      Z, CHARTR2      ; Yes - return
+        RET     Z               ; Yes - return
         CP      08H             ; Backspace ?
-        jr      Z, CHARTR2      ; Yes - return
+        RET     Z               ; Yes - return
         push af
         ld      c, BDOS_Console_Output
         ld      e, a
@@ -2867,12 +2904,10 @@ CHARTR1:
         pop af
         AND     7FH           ; Mask off parity bit
         CP      7BH           ; Upper range check (z+l)
-        jp      P, CHARTR2               ; No need to fold - return
+        RET     P               ; No need to fold - return
         CP      61H           ; Lower-range check (a)
-        jp     M, CHARTR2               ; No need to fold - return
+        RET     M               ; No need to fold - return
         SUB     20H           ; Change to one of A-Z
-CHARTR2:
-        pop     hl
         RET                     ; Return
 
 ;***********************************************************
@@ -4099,6 +4134,1182 @@ savegame:
 	EXIT			; quit
 ;
 ;********************************************************************
+;	Pondering (thinking on the player's time)
+;
+;	While the search runs, PVSAVE keeps the best reply found at ply 2
+;	for the current best root move. After the computer has moved,
+;	PNDPLY plays that predicted reply on the board array and searches
+;	the resulting position, polling the keyboard from FNDMOV (PNDPOL).
+;	The keys typed meanwhile are echoed and compared with the predicted
+;	move; the first mismatch abandons the search, restores the position
+;	and hands the typed keys to PLYRMV through CHARTR (PNDGET).
+;	If the player types the predicted move, the search simply goes on
+;	and its result is played by PNDCPT without searching again.
+;
+PONDON:	defb	1		;1 = pondering enabled
+PNDFLG:	defb	0		;1 = FNDMOV is pondering
+PNDHIT:	defb	0		;1 = player typed the predicted move
+PNDTFL:	defb	0		;1 = PNDEND holds the player's move end time
+PNDCNT:	defb	0		;poll counter, used to refresh the clock
+PNDNUM:	defb	0		;chars typed while pondering
+PNDOUT:	defb	0		;chars already handed to CHARTR
+PNDMRK:	defb	' '		;' ' or '*' (ponder hit) before move time
+PVREPLY:defw	0		;predicted reply ("from","to")
+PVTMP:	defw	0		;best reply to the root move being searched
+PNDSP:	defw	0		;SP to restore when the search is abandoned
+PNDEND:	defs	3		;H,M,S when the predicted move was typed
+PNDTXT:	defs	5		;predicted move as typed, e.g. "E7-E5"
+PNDBUF:	defs	5		;chars typed while pondering
+PNDMV:	defs	12		;move list entry (or two) of the predicted move
+PNDSAV:	defs	0ABH+34H	;BOARDA... and M1... snapshot (as in Record)
+;
+;	Called by FNDMOV on entering a new ply
+;
+PNDPOL:
+	ld	a,(NPLY)
+	dec	a		;descending from a root move ?
+	jr	nz,1f
+	ld	h,a		;yes, forget the reply of the previous one
+	ld	l,a
+	ld	(PVTMP),hl
+1:
+	ld	a,(PNDFLG)	;pondering ?
+	or	a
+	ret	z
+	cp	2		;no, timed EPD search ?
+	jp	z,EPDPOL
+	push	ix
+	push	iy
+	ld	hl,PNDCNT	;refresh the clock from time to time
+	inc	(hl)
+	ld	a,(hl)
+	and	1FH
+	call	z,GetTime
+	ld	a,(PNDHIT)	;predicted move already typed ?
+	or	a
+	jr	nz,2f		;yes, just go on searching
+	ld	c,BDOS_Console_Direct
+	ld	e,0FFH
+	call	BDOS		;key pressed ?
+	or	a
+	jr	z,2f
+	call	PNDKEY		;check it against the prediction
+	jr	z,2f
+	ld	sp,(PNDSP)	;mismatch, abandon the search
+	jp	PNDBRK
+2:
+	pop	iy
+	pop	ix
+	ret
+;
+;	Called by FNDMOV each time a better score is saved one ply above
+;
+PVSAVE:
+	ld	a,(NPLY)
+	cp	2		;best reply to the current root move ?
+	jr	nz,1f
+	ld	hl,(MLPTRJ)
+	inc	hl		;skip link
+	inc	hl
+	ld	a,(hl)		;"from"
+	ld	(PVTMP),a
+	inc	hl
+	ld	a,(hl)		;"to"
+	ld	(PVTMP+1),a
+	ret
+1:
+	dec	a		;new best root move ?
+	ret	nz
+	ld	hl,(PVTMP)	;yes, its best reply is the prediction
+	ld	(PVREPLY),hl
+	ret
+;
+;	A = key typed while pondering
+;	Echoes it, stores it in PNDBUF and compares it with PNDTXT
+;	returns Z if still matching, NZ on mismatch
+;
+PNDKEY:
+	call	CHFOLD		;echo & fold, as CHARTR does
+	ld	c,a
+	ld	hl,PNDNUM
+	ld	e,(hl)
+	inc	(hl)
+	ld	d,0
+	ld	hl,PNDBUF
+	add	hl,de
+	ld	(hl),c		;store it
+	ld	a,e
+	cp	2		;separator ?
+	jr	z,1f		;accept anything, as PLYRMV does
+	ld	hl,PNDTXT
+	add	hl,de
+	ld	a,c
+	cp	(hl)
+	ret	nz		;mismatch
+1:
+	ld	a,e
+	cp	4		;whole move typed ?
+	jr	nz,2f
+	ld	a,1		;yes, ponder hit
+	ld	(PNDHIT),a
+	ld	a,(PNDFLG)	;search still running ?
+	or	a
+	jr	z,2f
+	call	GetTime		;yes, the player's time ends now
+	ld	a,l
+	ld	hl,PNDEND
+	ld	(hl),a		;H
+	inc	hl
+	ld	(hl),d		;M
+	inc	hl
+	ld	(hl),e		;S
+	ld	a,1
+	ld	(PNDTFL),a
+2:
+	xor	a		;Z = still matching
+	ret
+;
+;	Get a char typed ahead while pondering
+;	returns NZ and A = char, or Z if none left
+;
+PNDGET:
+	ld	hl,PNDOUT
+	ld	a,(PNDNUM)
+	cp	(hl)
+	jr	nz,1f
+	xor	a		;none left, reset buffer
+	ld	(hl),a
+	ld	(PNDNUM),a
+	ret
+1:
+	ld	e,(hl)
+	inc	(hl)
+	ld	d,0
+	ld	hl,PNDBUF
+	add	hl,de
+	ld	a,(hl)
+	or	a		;NZ
+	ret
+;
+;	Accept and make players move, pondering meanwhile if possible
+;
+PNDPLY:
+	xor	a
+	ld	(PNDHIT),a
+	ld	(PNDNUM),a
+	ld	(PNDOUT),a
+	ld	a,(PONDON)	;pondering enabled ?
+	or	a
+	jp	z,PLYRMV
+	ld	hl,(PVREPLY)	;reply predicted ?
+	ld	a,h
+	or	a
+	jp	z,PLYRMV
+				;save position
+	ld	hl,BOARDA
+	ld	de,PNDSAV
+	ld	bc,0ABH
+	ldir
+	ld	hl,M1
+	ld	bc,34H
+	ldir
+				;build the predicted move text
+	ld	a,(PVREPLY)
+	ld	d,a
+	call	BITASN
+	res	5,l		;file to upper case
+	ld	(PNDTXT),hl
+	ld	a,'-'
+	ld	(PNDTXT+2),a
+	ld	a,(PVREPLY+1)
+	ld	d,a
+	call	BITASN
+	res	5,l
+	ld	(PNDTXT+3),hl
+				;make the predicted move
+	ld	hl,(PVREPLY)
+	ld	(MVEMSG),hl	;"from","to"
+	call	VALMOV
+	or	a		;legal ?
+	jr	nz,PNDRST	;no, just wait for the player
+	ld	hl,(MLPTRJ)	;keep its move list entry
+	ld	de,PNDMV
+	ld	bc,12
+	ldir
+	ld	a,(KOLOR)	;computer is white ?
+	or	a
+	jr	nz,1f
+	ld	hl,MOVENO	;yes, its next move has the next number
+	inc	(hl)
+1:
+	ld	a,1
+	ld	(PNDFLG),a
+	ld	(PNDSP),sp
+	call	FNDMOV		;search while the player thinks
+	xor	a
+	ld	(PNDFLG),a
+	ld	a,(KOLOR)
+	or	a
+	jr	nz,2f
+	ld	hl,MOVENO
+	dec	(hl)
+2:
+	ld	a,(PNDHIT)	;predicted move typed ?
+	or	a
+	jr	nz,3f		;yes
+	call	GetTime		;no, wait for the rest of it
+	ld	c,BDOS_Console_Direct
+	ld	e,0FFH
+	call	BDOS
+	or	a
+	jr	z,2b
+	call	PNDKEY
+	jr	z,2b
+	jr	PNDRST
+3:
+	ld	hl,PNDMV	;show the predicted move on the board
+	ld	(MLPTRJ),hl
+	jp	EXECMV
+;
+;	Search abandoned: restore position, PLYRMV gets the typed chars
+;
+PNDBRK:
+	xor	a
+	ld	(PNDFLG),a
+	ld	(PNDHIT),a
+PNDRST:
+	ld	hl,PNDSAV
+	ld	de,BOARDA
+	ld	bc,0ABH
+	ldir
+	ld	de,M1
+	ld	bc,34H
+	ldir
+	jp	PLYRMV
+;
+;	Make and write computers move, using the pondering result if any
+;
+PNDCPT:
+	ld	a,' '
+	ld	(PNDMRK),a
+	ld	hl,PNDHIT
+	ld	a,(hl)
+	or	a
+	jp	z,CPTRMV
+	ld	(hl),0
+	ld	a,'*'
+	ld	(PNDMRK),a
+	jp	CPTRM1		;best move already found
+;
+;	Time the player's move up to the moment the predicted move was typed
+;
+PNDSTP:
+	ld	a,(PNDTFL)
+	or	a
+	jp	z,GetStopTime
+	ld	hl,PNDEND
+	ld	de,StopTime
+	ld	bc,3
+	ldir
+	ret
+;
+;	...and the computer's move from that moment on
+;
+PNDSTA:
+	ld	hl,PNDTFL
+	ld	a,(hl)
+	or	a
+	jp	z,GetStartTime
+	ld	(hl),0
+	ld	hl,PNDEND
+	ld	de,StartTime
+	ld	bc,3
+	ldir
+	ret
+;
+;********************************************************************
+;	EPD test suite runner (headless benchmark)
+;
+;	SARGON78 infile outfile [depth | Tseconds] [V]
+;
+;	Reads the positions (one per line) from the EPD file infile,
+;	searches each one at the given depth (default 3) or, with T,
+;	deepens from 1 to 6 until the given number of seconds is spent,
+;	and writes to outfile one line per position:
+;
+;	move d=depth score=s nodes=n time=hh:mm:ss nps=x epd-operations
+;
+;	followed by a totals line. Nodes are the positions evaluated
+;	by POINTS. The screen and the keyboard are not used, so it runs
+;	unattended under a CP/M emulator; times come from the DS1302.
+;	With V, the lines written are also echoed on the console.
+;
+EPDDEP:	defb	3		;search depth
+EPDSEC:	defw	0		;seconds per move (0 = fixed depth)
+EPDCD:	defb	0		;depth being searched
+EPDDP:	defb	0		;deepest completed depth
+EPDFR:	defb	0		;its best move "from" (0 = none)
+EPDTO:	defb	0		;its best move "to"
+EPDSC:	defb	0		;its score
+EPDCR:	defb	0		;castling rights: 1=K 2=Q 4=k 8=q
+EPDSQ:	defb	0		;current square while parsing
+EPDRK:	defb	0		;first square of the current rank
+EPDIP:	defb	128		;input buffer index (128 = empty)
+EPDOP:	defb	0		;output buffer index
+EPDECH:	defb	0		;1 = echo the output on the console
+EPDPOS:	defw	0		;positions searched
+NODES:	defs	4		;positions evaluated, this search
+TNODES:	defs	4		;positions evaluated, all searches
+EPDV:	defs	4		;D32 operand
+EPDTS:	defs	3		;H,M,S at suite start
+EPDEP:	defb	0,0,0,0,0,0	;last move entry, for en passant
+EPDPCS:	defm	'PNBRQKpnbrqk'
+EPDIFC:	defs	36		;input fcb
+EPDOFC:	defs	36		;output fcb
+EPDIBF:	defs	128		;input record
+EPDOBF:	defs	128		;output record
+EPDINI:	defs	120		;initial board, to find unmoved pieces
+EPDLIN:	defs	128		;current line
+;
+EpdUsage:
+	defm	'usage: SARGON78 infile outfile [depth | Tseconds] [V]$'
+NoInput:
+	defm	'cannot open the EPD file$'
+NoOutput:
+	defm	'cannot create the output file$'
+EpdNodes:
+	defm	' nodes=$'
+EpdTime:
+	defm	' time=$'
+EpdNps:
+	defm	' nps=$'
+EpdTotal:
+	defm	'total positions=$'
+;
+;	Increment the node counter (called by POINTS)
+;
+CNTNOD:
+	ld	hl,NODES
+	inc	(hl)
+	ret	nz
+	inc	hl
+	inc	(hl)
+	ret	nz
+	inc	hl
+	inc	(hl)
+	ret	nz
+	inc	hl
+	inc	(hl)
+	ret
+;
+;	Called by PNDPOL during a timed search
+;
+EPDPOL:
+	ld	hl,PNDCNT	;check the time from time to time
+	inc	(hl)
+	ld	a,(hl)
+	and	1FH
+	ret	nz
+	call	GetStopTime
+	call	ComputeLapse
+	ld	hl,(DeltaSecs)
+	ld	de,(EPDSEC)
+	or	a
+	sbc	hl,de		;time is up ?
+	ret	c
+	ld	sp,(PNDSP)	;yes, abandon this depth
+	jp	EPDEND
+;
+;	Run the test suite
+;
+EPDRUN:
+	ld	a,(6DH)		;output file name given ?
+	cp	' '
+	jr	nz,1f
+	ld	de,EpdUsage
+	call	show_string_de
+	jp	0
+1:
+	ld	hl,5CH		;copy file names from the default fcbs
+	ld	de,EPDIFC
+	ld	bc,12
+	ldir
+	ld	hl,6CH
+	ld	de,EPDOFC
+	ld	bc,12
+	ldir
+	xor	a		;clear EX...CR,R0..R2
+	ld	b,36-12
+	ld	hl,EPDIFC+12
+	ld	de,EPDOFC+12
+1:
+	ld	(hl),a
+	ld	(de),a
+	inc	hl
+	inc	de
+	djnz	1b
+	ld	h,a		;clear total node count
+	ld	l,a
+	ld	(TNODES),hl
+	ld	(TNODES+2),hl
+	ld	a,(80H)		;terminate the command tail
+	ld	l,a
+	ld	de,81H
+	add	hl,de
+	ld	(hl),0
+	ld	hl,81H		;third word of the command tail
+	call	EPDWRD
+	call	EPDWRD
+	call	EPDSPC
+	cp	'T'		;time per move ?
+	jr	nz,1f
+	inc	hl
+	ld	de,0
+2:				;DE = decimal number
+	ld	a,(hl)
+	sub	'0'
+	jr	c,3f
+	cp	10
+	jr	nc,3f
+	inc	hl
+	push	hl
+	ld	h,d
+	ld	l,e
+	add	hl,hl
+	add	hl,hl
+	add	hl,de
+	add	hl,hl		;x 10
+	ld	e,a
+	ld	d,0
+	add	hl,de
+	ex	de,hl
+	pop	hl
+	jr	2b
+3:
+	ld	(EPDSEC),de
+	jr	4f
+1:
+	sub	'1'		;depth 1...6 ?
+	jr	c,4f
+	cp	6
+	jr	nc,4f
+	inc	a
+	ld	(EPDDEP),a
+4:
+	ld	hl,81H		;V among the words after the file names ?
+	call	EPDWRD
+	call	EPDWRD
+5:
+	ld	a,(hl)
+	or	a
+	jr	z,7f
+	cp	'V'
+	jr	nz,6f
+	inc	hl
+	ld	a,(hl)
+	cp	' '+1
+	jr	nc,6f
+	ld	a,1		;yes, echo on
+	ld	(EPDECH),a
+	jr	7f
+6:
+	call	EPDWRD
+	jr	5b
+7:
+	ld	de,EPDIFC	;open input
+	ld	c,15
+	call	BDOS
+	inc	a
+	jr	nz,1f
+	ld	de,NoInput
+	call	show_string_de
+	jp	0
+1:
+	ld	de,EPDOFC	;create output
+	ld	c,19
+	call	BDOS
+	ld	de,EPDOFC
+	ld	c,22
+	call	BDOS
+	inc	a
+	jr	nz,1f
+	ld	de,NoOutput
+	call	show_string_de
+	jp	0
+1:
+	call	GetTime		;suite start time
+	ld	a,l
+	ld	hl,EPDTS
+	ld	(hl),a
+	inc	hl
+	ld	(hl),d
+	inc	hl
+	ld	(hl),e
+EPDNXT:				;next position
+	call	EPDRDL
+	jp	c,EPDFIN	;end of file
+	ld	hl,EPDLIN
+	call	EPDSPC
+	or	a		;empty line ?
+	jr	z,EPDNXT
+	cp	';'		;comment ?
+	jr	z,EPDNXT
+	push	hl
+	call	INITBD		;keep the initial position
+	ld	hl,BOARDA
+	ld	de,EPDINI
+	ld	bc,120
+	ldir
+	ld	a,21		;empty the board
+1:
+	ld	(M1),a
+	ld	ix,(M1)
+	ld	a,(ix+BOARD)
+	inc	a		;border ?
+	jr	z,2f
+	ld	(ix+BOARD),0
+2:
+	ld	a,(M1)
+	inc	a
+	cp	99
+	jr	nz,1b
+	pop	hl
+				;piece placement, from a8
+	ld	a,91
+	ld	(EPDRK),a
+	ld	(EPDSQ),a
+EPDPLC:
+	ld	a,(hl)
+	or	a
+	jp	z,EPDNXT	;truncated line
+	inc	hl
+	cp	' '
+	jr	z,EPDSID
+	cp	'/'		;next rank ?
+	jr	nz,1f
+	ld	a,(EPDRK)
+	sub	10
+	ld	(EPDRK),a
+	ld	(EPDSQ),a
+	jr	EPDPLC
+1:
+	cp	'1'		;empty squares ?
+	jr	c,2f
+	cp	'9'
+	jr	nc,2f
+	sub	'0'
+	ld	b,a
+	ld	a,(EPDSQ)
+	add	a,b
+	ld	(EPDSQ),a
+	jr	EPDPLC
+2:
+	push	hl
+	ld	hl,EPDPCS	;piece letter ?
+	ld	bc,12
+	cpir
+	pop	hl
+	jr	nz,EPDPLC	;no, ignore it
+	ld	a,11		;index = 11 - BC
+	sub	c
+	cp	6		;black ?
+	jr	c,3f
+	add	a,BLACK-6
+3:
+	inc	a		;PAWN...KING
+	ld	c,a
+	ld	a,(EPDSQ)
+	cp	21		;off the board ?
+	jr	c,4f
+	cp	99
+	jr	nc,4f
+	ld	(M1),a
+	ld	ix,(M1)
+	ld	a,(ix+BOARD)
+	inc	a
+	jr	z,4f
+	ld	(ix+BOARD),c
+4:
+	ld	a,(EPDSQ)
+	inc	a
+	ld	(EPDSQ),a
+	jr	EPDPLC
+EPDSID:				;side to move
+	call	EPDSPC
+	inc	hl
+	ld	c,0
+	cp	'b'
+	jr	nz,1f
+	ld	c,BLACK
+1:
+	ld	a,c
+	ld	(KOLOR),a
+	ld	(COLOR),a
+				;castling rights
+	call	EPDSPC
+	ld	c,0
+1:
+	ld	a,(hl)
+	cp	' '+1
+	jr	c,3f
+	inc	hl
+	ld	b,1
+	cp	'K'
+	jr	z,2f
+	ld	b,2
+	cp	'Q'
+	jr	z,2f
+	ld	b,4
+	cp	'k'
+	jr	z,2f
+	ld	b,8
+	cp	'q'
+	jr	nz,1b
+2:
+	ld	a,c
+	or	b
+	ld	c,a
+	jr	1b
+3:
+	ld	a,c
+	ld	(EPDCR),a
+				;en passant square
+	call	EPDSPC
+	xor	a
+	ld	(EPDEP+MLFLG),a
+	ld	a,(hl)
+	cp	'a'
+	jr	c,2f
+	cp	'h'+1
+	jr	nc,2f
+	sub	'a'-1		;file 1...8
+	ld	c,a
+	inc	hl
+	ld	a,(hl)
+	sub	'0'-1		;rank 2...9
+	ld	b,a
+	add	a,a
+	add	a,a
+	add	a,b
+	add	a,a		;x 10
+	add	a,c		;ep square
+	ld	c,a
+	ld	a,(KOLOR)	;pawn that just moved two squares
+	or	a
+	ld	a,c
+	jr	nz,1f
+	sub	20		;black pawn
+1:
+	add	a,10		;white pawn
+	ld	(EPDEP+MLTOP),a
+	ld	a,10H		;its first move
+	ld	(EPDEP+MLFLG),a
+2:
+	ld	a,(hl)		;skip the field
+	cp	' '+1
+	jr	c,3f
+	inc	hl
+	jr	2b
+3:
+	call	EPDSPC
+	push	hl		;operations, copied to the output
+				;mark the pieces that have moved
+	ld	a,21
+1:
+	ld	(M1),a
+	ld	ix,(M1)
+	ld	a,(ix+BOARD)
+	or	a
+	jr	z,2f
+	inc	a
+	jr	z,2f
+	dec	a
+	ld	hl,EPDINI	;on its initial square ?
+	ld	de,(M1)
+	ld	d,0
+	add	hl,de
+	cp	(hl)
+	jr	z,2f
+	set	3,(ix+BOARD)	;no, it has moved
+2:
+	ld	a,(M1)
+	inc	a
+	cp	99
+	jr	nz,1b
+	ld	a,(EPDCR)	;castling rights lost
+	ld	c,a
+	ld	a,28		;h1
+	bit	0,c
+	call	z,EPDMVD
+	ld	a,21		;a1
+	bit	1,c
+	call	z,EPDMVD
+	ld	a,98		;h8
+	bit	2,c
+	call	z,EPDMVD
+	ld	a,91		;a8
+	bit	3,c
+	call	z,EPDMVD
+	ld	a,c
+	and	3
+	ld	a,25		;e1
+	call	z,EPDMVD
+	ld	a,c
+	and	0CH
+	ld	a,95		;e8
+	call	z,EPDMVD
+	call	ROYALT		;Kings & Queens positions
+				;search
+	ld	a,2		;not the first move (no book)
+	ld	(MOVENO),a
+	xor	a
+	ld	(EPDFR),a
+	ld	(EPDDP),a
+	ld	(PNDFLG),a
+	ld	h,a
+	ld	l,a
+	ld	(NODES),hl
+	ld	(NODES+2),hl
+	call	GetStartTime
+	ld	a,(EPDDEP)	;fixed depth ...
+	ld	b,a
+	ld	hl,(EPDSEC)
+	ld	a,h
+	or	l
+	jr	z,1f
+	ld	b,1		;... or deepen from 1
+1:
+	ld	a,b
+	ld	(PLYMAX),a
+	ld	(EPDCD),a
+	ld	hl,EPDEP	;"previous move"
+	ld	(MLPTRJ),hl
+	ld	(PNDSP),sp
+	call	FNDMOV
+	ld	a,(EPDCD)
+	ld	(EPDDP),a
+	ld	a,(SCORE+1)
+	ld	(EPDSC),a
+	ld	hl,(BESTM)
+	ld	a,h
+	or	a
+	jr	z,2f		;no legal move
+	inc	hl
+	inc	hl
+	ld	a,(hl)
+	ld	(EPDFR),a
+	inc	hl
+	ld	a,(hl)
+	ld	(EPDTO),a
+2:
+	ld	hl,(EPDSEC)	;timed ?
+	ld	a,h
+	or	l
+	jr	z,EPDEND
+	ld	a,(EPDSC)	;mate found ?
+	inc	a
+	jr	z,EPDEND
+	ld	a,(EPDDP)
+	cp	6		;deepest ?
+	jr	nc,EPDEND
+	call	GetStopTime
+	call	ComputeLapse
+	ld	hl,(DeltaSecs)
+	ld	de,(EPDSEC)
+	or	a
+	sbc	hl,de		;time is up ?
+	jr	nc,EPDEND
+	ld	a,2		;no, next depth may be abandoned
+	ld	(PNDFLG),a
+	ld	a,(EPDDP)
+	inc	a
+	ld	b,a
+	jr	1b
+EPDEND:				;write the result
+	xor	a
+	ld	(PNDFLG),a
+	call	GetStopTime
+	call	ComputeLapse
+	ld	hl,(EPDPOS)
+	inc	hl
+	ld	(EPDPOS),hl
+	ld	de,NODES	;add to total
+	ld	hl,TNODES
+	ld	b,4
+	or	a
+1:
+	ld	a,(de)
+	adc	a,(hl)
+	ld	(hl),a
+	inc	de
+	inc	hl
+	djnz	1b
+	ld	a,(EPDFR)	;move
+	or	a
+	jr	nz,1f
+	ld	hl,EpdNone
+	call	EPDSTR
+	jr	2f
+1:
+	ld	d,a
+	call	BITASN
+	ld	a,l
+	call	EPDPC
+	ld	a,h
+	call	EPDPC
+	ld	a,'-'
+	call	EPDPC
+	ld	a,(EPDTO)
+	ld	d,a
+	call	BITASN
+	ld	a,l
+	call	EPDPC
+	ld	a,h
+	call	EPDPC
+2:
+	ld	hl,EpdDepth	;depth
+	call	EPDSTR
+	ld	a,(EPDDP)
+	add	a,'0'
+	call	EPDPC
+	ld	hl,EpdScore	;score, 0 = even
+	call	EPDSTR
+	ld	a,(EPDSC)
+	sub	80H
+	jp	p,3f
+	neg
+	push	af
+	ld	a,'-'
+	call	EPDPC
+	pop	af
+3:
+	ld	l,a
+	ld	h,0
+	call	EPDD16
+	ld	hl,NODES
+	call	EPDNPS		;nodes, time, nps
+	ld	a,' '
+	call	EPDPC
+	pop	hl		;operations
+	call	EPDSTR
+	call	EPDEOL
+	jp	EPDNXT
+EPDFIN:				;totals
+	ld	hl,EpdTotal
+	call	EPDSTR
+	ld	hl,(EPDPOS)
+	call	EPDD16
+	ld	hl,EPDTS
+	ld	de,StartTime
+	ld	bc,3
+	ldir
+	call	GetStopTime
+	call	ComputeLapse
+	ld	hl,TNODES
+	call	EPDNPS
+	call	EPDEOL
+	ld	a,1AH		;flush, with EOF marks
+1:
+	call	EPDPF
+	ld	a,(EPDOP)
+	or	a
+	ld	a,1AH
+	jr	nz,1b
+	ld	de,EPDOFC	;close output
+	ld	c,16
+	call	BDOS
+	jp	0
+;
+EpdNone:defm	'none'
+	defb	0
+EpdDepth:
+	defm	' d='
+	defb	0
+EpdScore:
+	defm	' score='
+	defb	0
+;
+;	Mark the piece on square A as moved
+;
+EPDMVD:
+	ld	(M1),a
+	ld	ix,(M1)
+	ld	a,(ix+BOARD)
+	or	a
+	ret	z
+	set	3,(ix+BOARD)
+	ret
+;
+;	HL = 4 bytes node count; writes nodes=, time= (TimeASCII)
+;	and nps= (nodes / DeltaSecs)
+;
+EPDNPS:
+	push	hl
+	ld	de,EPDV
+	ld	bc,4
+	ldir
+	ld	de,EpdNodes
+	call	EPDS
+	call	EPDD32
+	ld	de,EpdTime
+	call	EPDS
+	ld	de,TimeASCII
+	call	EPDS
+	ld	de,EpdNps
+	call	EPDS
+	pop	hl
+	ld	de,EPDV
+	ld	bc,4
+	ldir
+	ld	de,(DeltaSecs)
+	ld	a,d
+	or	e
+	jr	z,1f		;less than one second
+	call	D32
+	jr	EPDD32
+1:
+	ld	a,'-'
+	jp	EPDPC
+;
+;	Write the '$' terminated string at DE
+;
+EPDS:
+	ld	a,(de)
+	cp	'$'
+	ret	z
+	call	EPDPC
+	inc	de
+	jr	EPDS
+;
+;	Write the 0 terminated string at HL
+;
+EPDSTR:
+	ld	a,(hl)
+	or	a
+	ret	z
+	call	EPDPC
+	inc	hl
+	jr	EPDSTR
+;
+;	Write HL in decimal
+;
+EPDD16:
+	ld	(EPDV),hl
+	ld	hl,0
+	ld	(EPDV+2),hl
+;
+;	Write (EPDV) in decimal
+;
+EPDD32:
+	ld	c,0		;digits count
+1:
+	push	bc
+	ld	de,10
+	call	D32
+	pop	bc
+	ld	a,l
+	add	a,'0'
+	push	af
+	inc	c
+	ld	hl,(EPDV)
+	ld	a,h
+	or	l
+	ld	hl,(EPDV+2)
+	or	h
+	or	l
+	jr	nz,1b
+2:
+	pop	af
+	call	EPDPC
+	dec	c
+	jr	nz,2b
+	ret
+;
+;	(EPDV) = (EPDV) / DE, HL = remainder
+;
+D32:
+	ld	hl,0
+	ld	b,32
+1:
+	push	hl
+	ld	hl,EPDV
+	sla	(hl)
+	inc	hl
+	rl	(hl)
+	inc	hl
+	rl	(hl)
+	inc	hl
+	rl	(hl)
+	pop	hl
+	adc	hl,hl
+	or	a
+	sbc	hl,de
+	jr	nc,2f
+	add	hl,de
+	jr	3f
+2:
+	ld	a,(EPDV)
+	inc	a
+	ld	(EPDV),a
+3:
+	djnz	1b
+	ret
+;
+;	Write CR,LF
+;
+EPDEOL:
+	ld	a,0DH
+	call	EPDPC
+	ld	a,0AH
+;
+;	Write A to the output file, and to the console if echo is on
+;	BC,DE,HL not affected
+;
+EPDPC:
+	push	bc
+	push	de
+	push	hl
+	push	af
+	ld	e,a
+	ld	a,(EPDECH)
+	or	a
+	ld	c,BDOS_Console_Output
+	call	nz,BDOS
+	pop	af
+	pop	hl
+	pop	de
+	pop	bc
+;
+;	Write A to the output file
+;	BC,DE,HL not affected
+;
+EPDPF:
+	push	bc
+	push	de
+	push	hl
+	ld	hl,EPDOP
+	ld	e,(hl)
+	inc	(hl)
+	ld	d,0
+	ld	hl,EPDOBF
+	add	hl,de
+	ld	(hl),a
+	ld	a,e
+	cp	127		;record full ?
+	jr	nz,1f
+	xor	a
+	ld	(EPDOP),a
+	ld	de,EPDOBF	;yes, write it
+	ld	c,26
+	call	BDOS
+	ld	de,EPDOFC
+	ld	c,21
+	call	BDOS
+	or	a
+	jr	z,1f
+	ld	de,CannotWrite
+	call	show_string_de
+	jp	0
+1:
+	pop	hl
+	pop	de
+	pop	bc
+	ret
+;
+;	Read a line into EPDLIN (0 terminated)
+;	returns CARRY set at end of file
+;
+EPDRDL:
+	ld	hl,EPDLIN
+	ld	b,127		;room left
+1:
+	call	EPDGC
+	jr	c,3f
+	cp	0DH
+	jr	z,1b		;CR ignored
+	cp	0AH
+	jr	z,4f
+	cp	9		;TAB as space
+	jr	nz,2f
+	ld	a,' '
+2:
+	ld	c,a
+	ld	a,b
+	or	a
+	jr	z,1b		;too long, truncate
+	ld	(hl),c
+	inc	hl
+	dec	b
+	jr	1b
+3:
+	ld	a,b		;end of file
+	cp	127		;anything read ?
+	scf
+	ret	z		;no
+4:
+	ld	(hl),0
+	or	a
+	ret
+;
+;	Get a char from the input file
+;	returns CARRY set at end of file
+;
+EPDGC:
+	push	hl
+	push	bc
+	ld	a,(EPDIP)
+	cp	128		;record used up ?
+	jr	nz,1f
+	ld	de,EPDIBF	;read next one
+	ld	c,26
+	call	BDOS
+	ld	de,EPDIFC
+	ld	c,20
+	call	BDOS
+	or	a
+	jr	nz,2f
+1:
+	ld	e,a
+	inc	a
+	ld	(EPDIP),a
+	ld	d,0
+	ld	hl,EPDIBF
+	add	hl,de
+	ld	a,(hl)
+	cp	1AH		;^Z ?
+	jr	z,2f
+	or	a
+	jr	3f
+2:
+	ld	a,128		;stay at end of file
+	ld	(EPDIP),a
+	scf
+3:
+	pop	bc
+	pop	hl
+	ret
+;
+;	Skip the word at HL and the spaces after it
+;
+EPDWRD:
+	call	EPDSPC
+1:
+	ld	a,(hl)
+	cp	' '+1
+	jr	c,EPDSPC
+	inc	hl
+	jr	1b
+;
+;	Skip spaces at HL, returns A = next char
+;
+EPDSPC:
+	ld	a,(hl)
+	cp	' '
+	ret	nz
+	inc	hl
+	jr	EPDSPC
+;
+;********************************************************************
 ;	Time lapse computing
 ;
 StartTime:	defs	3	;H,M,S
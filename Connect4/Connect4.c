@@ -1,6 +1,7 @@
 // Connect Four game
 //
-// Using Gaelen McIntee's hint about computer's move strategy
+// Engine: negamax with alpha-beta pruning, center-first move ordering
+// and a transposition table, over incremental four-in-a-row line counters
 //
 // Ladislau Szilagyi, July 2023
 
@@ -12,6 +13,22 @@
 //uncomment for VT52/Z80ALL, else it will be VT100 compatible
 #define Z80ALL
 
+//uncomment (with Z80ALL) to write straight to the VGA screen,
+//else the screen is written through the BIOS
+//#define VGA
+
+#ifdef Z80ALL
+#include "rtclib.h"
+#endif
+
+#ifdef VGA
+#include "vga.h"
+#undef putchar
+#define putchar(c)	VPutc(c)
+#define putch(c)	VPutc(c)
+#define printf(s)	VPuts(s)	// the numbers are formatted by sprintf
+#endif
+
 #define bool char
 #define TRUE 1
 #define FALSE 0
@@ -20,25 +37,95 @@
 #define COLS 7
 
 #define ESCAPE 0x1B
+#define CR 0x0D
+
+#define INF	30000
+#define WIN	1000		// WIN - ply = win found at that ply
+#define MAXPLY	(ROWS*COLS)
+#define MAXDEPTH 9
 
-char board[ROWS][COLS];
+#define LINES	69		// possible four-in-a-row lines
+#define MAXCL	13		// max lines through a cell
+
+#define TTSIZE	512		// must be a power of 2
+#define TT_EXACT 1
+#define TT_LOWER 2
+#define TT_UPPER 3
+
+struct tte
+{
+	unsigned int lock;	// second hash key, verifies the entry
+	int score;
+	char depth;
+	char flag;		// 0 = empty, else TT_EXACT/LOWER/UPPER
+	char move;
+};
+
+struct tte tt[TTSIZE];
+
+char board[ROWS][COLS];	// used only to print the board
 char toMove;	// O = player, X = computer
 
+char height[COLS];	// chips dropped in each column
+char side;		// side to move, 0 = O, 1 = X
+char moves;		// chips on board
+
+// Cells are numbered row*COLS+col, row counted from the bottom
+char lineCells[LINES][4];	// cells of each line
+char cellLines[ROWS*COLS][MAXCL];	// lines through each cell
+char cellLineCnt[ROWS*COLS];
+char nlines;
+
+// Per side (0 = O, 1 = X), updated by make/unmake
+char lineCount[2][LINES];	// chips in each line
+char threat[2][ROWS*COLS];	// lines with 3 chips of this side and none
+				// of the other passing through the cell
+				// (on an empty cell : dropping there wins)
+char fours[2];			// lines completed
+int points[2];			// sum of lineValue[] over the lines
+				// not blocked by the other side
+char lineValue[5] = { 0, 1, 3, 9, 0 };
+
+unsigned int hash;	// Zobrist keys of the current position
+unsigned int lock;
+unsigned int zhash[2][COLS][ROWS];
+unsigned int zlock[2][COLS][ROWS];
+
+char order[COLS] = { 3, 2, 4, 1, 5, 0, 6 };	// center first
+
+char line[80];		// formatted messages
+
+char maxDepth;		// search depth, or MAXPLY if timed
+char seconds;		// time per move, 0 = fixed depth
+char rootDepth;
+bool aborted;
+unsigned int nodes;
+#ifdef Z80ALL
+long deadline;
+#endif
+
 void xrndseed(void);
 unsigned int xrnd(void);
 
 void clear(void)
 {
+#ifdef VGA
+    VClear();
+#else
 #ifdef Z80ALL
     putchar( ESCAPE ); putchar( 'H' );	//home
     putchar( ESCAPE ); putchar( 'J' );	//erase to end-of-screen
 #else
 printf("%c[2J%c[H",ESCAPE,ESCAPE);
 #endif
+#endif
 }
 
 void gotoxy(int y,int x)
 {
+#ifdef VGA
+    VLocate(y, x);
+#else
 #ifdef Z80ALL
     putchar( ESCAPE ); putchar( 'Y' );
     putchar( 31+y+1 );
@@ -46,15 +133,29 @@ void gotoxy(int y,int x)
 #else
 printf("%c[%d;%dH",27,y+1,x+1);
 #endif
+#endif
 }
 
 void eraseToEOS(void)
 {
+#ifdef VGA
+    VClearEOS();
+#else
 #ifdef Z80ALL
     putchar( ESCAPE ); putchar( 'J' );	//erase to end-of-screen
 #else
 printf("%c[J",ESCAPE);
 #endif
+#endif
+}
+
+// Quit, leaving the BIOS cursor after the text shown
+void quit(void)
+{
+#ifdef VGA
+	VSync();
+#endif
+	exit(1);
 }
 
 // Quit if Ctrl^C is hit
@@ -65,7 +166,7 @@ char GETCH(void)
 	c = getch();
 
 	if (c == 3)
-		exit(1);
+		quit();
 
 	return c;
 }
@@ -90,95 +191,196 @@ void print_board(void)
 	printf(" 1 2 3 4 5 6 7");
 }
 
-// Place the chip (toMove) in the given column. 
-// col = 0...6 
-// returns FALSE if column is already full 
-bool place_chip(int col)
+// Fill the Zobrist keys with random numbers
+void init_hash(void)
 {
-	int r;
-
-	for (r = ROWS - 1; r >= 0; r--)
-		if (board[r][col] == ' ')
-		{
-			board[r][col] = toMove;
-			return TRUE;
-		}
+	int s, c, r;
 
-	return FALSE;
+	for (s = 0; s < 2; s++)
+		for (c = 0; c < COLS; c++)
+			for (r = 0; r < ROWS; r++)
+			{
+				zhash[s][c][r] = xrnd();
+				zlock[s][c][r] = xrnd();
+			}
 }
 
-// Returns TRUE if table is full
-bool isFull(void)
+// Add the line starting at row r, col c, going by dr, dc
+void add_line(char r, char c, char dr, char dc)
 {
-	int col;
+	char i, cell;
 
-	for (col = 0; col < COLS; col++)
+	for (i = 0; i < 4; i++)
 	{
-		if (board[0][col] == ' ')
-			return FALSE;
+		cell = (r + i * dr) * COLS + c + i * dc;
+		lineCells[nlines][i] = cell;
+		cellLines[cell][cellLineCnt[cell]++] = nlines;
 	}
 
-	return TRUE;
+	nlines++;
 }
 
-// Returns 
-//	O : you won 
-//	X : computer won
-//	blank if no winner yet
-char winnerIs(void)
+// Build the tables of the 69 lines
+void init_lines(void)
 {
-	char cell;
-	int offset;
-	int row, col, i;
+	char r, c;
 
-	for (row = 0; row < ROWS; row++)
-		for (col = 0; col < COLS; col++)
+	for (r = 0; r < ROWS; r++)
+		for (c = 0; c < COLS; c++)
 		{
-			cell = board[row][col];
+			if (c <= COLS-4)
+				add_line(r, c, 0, 1);	//horizontal
 
-			if (cell == ' ')
-				continue;
-
-			/* Horizontal case */
-			for ( i = col; i < col+4; i++)
+			if (r <= ROWS-4)
 			{
-				if (i == COLS || board[row][i] != cell)
-					break;
+				add_line(r, c, 1, 0);	//vertical
+
+				if (c <= COLS-4)
+					add_line(r, c, 1, 1);	//up and right
 
-				if (i == col+3) 
-					return cell;
+				if (c >= 3)
+					add_line(r, c, 1, -1);	//up and left
 			}
+		}
+}
 
-			/* Vertical case */
-			for ( i = row; i < row+4; i++)
-			{
-				if (i == ROWS || board[i][col] != cell)
-					break;
+// Add d to the threat count of side s on the cells of line l
+void mark(char s, char l, char d)
+{
+	char *p;
 
-				if (i == row+3)
-					return cell;
-			}
+	p = lineCells[l];
+	threat[s][p[0]] += d;
+	threat[s][p[1]] += d;
+	threat[s][p[2]] += d;
+	threat[s][p[3]] += d;
+}
 
-			/* Up and Right case */
-			for ( i = col, offset = 0; i < col+4; i++, offset++)
-			{
-				if (i == COLS || (row-offset) < 0 || board[row-offset][i] != cell)
-					break;
+// Drop a chip of the side to move into col (must not be full)
+// Only the lines passing through the new chip are updated
+void make(char col)
+{
+	char r, cell, i, l, s, o, cs, co;
 
-				if (i == col+3)
-					return cell;
-			}
+	s = side;
+	o = s ^ 1;
+	r = height[col]++;
+	cell = r * COLS + col;
+
+	for (i = 0; i < cellLineCnt[cell]; i++)
+	{
+		l = cellLines[cell][i];
+		cs = lineCount[s][l]++;
+		co = lineCount[o][l];
 
-			/* Up and Left case */
-			for ( i = col, offset = 0; i > col-4; i--, offset++)
+		if (co == 0)
+		{
+			points[s] += lineValue[cs+1] - lineValue[cs];
+
+			if (cs == 2)
+				mark(s, l, 1);
+			else if (cs == 3)
 			{
-				if (i < 0 || (row-offset) < 0 || board[row-offset][i] != cell)
-					break;
+				mark(s, l, -1);
+				fours[s]++;
+			}
+		}
+		else if (cs == 0)
+		{
+			// line now blocked for the other side
+			points[o] -= lineValue[co];
+
+			if (co == 3)
+				mark(o, l, -1);
+		}
+	}
 
-				if (i == col-3) 
-					return cell;
+	hash ^= zhash[s][col][r];
+	lock ^= zlock[s][col][r];
+	moves++;
+	side = o;
+}
+
+// Take back the last chip dropped into col
+void unmake(char col)
+{
+	char r, cell, i, l, s, o, cs, co;
+
+	o = side;
+	s = o ^ 1;
+	r = --height[col];
+	cell = r * COLS + col;
+
+	for (i = 0; i < cellLineCnt[cell]; i++)
+	{
+		l = cellLines[cell][i];
+		cs = --lineCount[s][l];
+		co = lineCount[o][l];
+
+		if (co == 0)
+		{
+			points[s] -= lineValue[cs+1] - lineValue[cs];
+
+			if (cs == 2)
+				mark(s, l, -1);
+			else if (cs == 3)
+			{
+				mark(s, l, 1);
+				fours[s]--;
 			}
 		}
+		else if (cs == 0)
+		{
+			points[o] += lineValue[co];
+
+			if (co == 3)
+				mark(o, l, 1);
+		}
+	}
+
+	hash ^= zhash[s][col][r];
+	lock ^= zlock[s][col][r];
+	moves--;
+	side = s;
+}
+
+// Returns TRUE if the side to move wins by dropping a chip into col
+bool winsAt(char col)
+{
+	return threat[side][height[col] * COLS + col];
+}
+
+// Place the chip (toMove) in the given column.
+// col = 0...6
+// returns FALSE if column is already full
+bool place_chip(int col)
+{
+	if (height[col] == ROWS)
+		return FALSE;
+
+	board[ROWS - 1 - height[col]][col] = toMove;
+	make(col);
+
+	return TRUE;
+}
+
+// Returns TRUE if table is full
+bool isFull(void)
+{
+	return (moves == ROWS*COLS);
+}
+
+// Returns
+//	O : you won
+//	X : computer won
+//	blank if no winner yet
+char winnerIs(void)
+{
+	if (fours[0])
+		return 'O';
+
+	if (fours[1])
+		return 'X';
 
 	return ' ';
 }
@@ -186,396 +388,285 @@ char winnerIs(void)
 // Returns TRUE is column is full
 bool colFull(int col)
 {
-	return (board[0][col] != ' ');
+	return (height[col] == ROWS);
 }
 
-// Returns a random non-full column (0 to 6)
-int randomInt(void)
+#ifdef Z80ALL
+// Returns the time of day, in seconds
+long now(void)
 {
-	int i;
+	long t;
 
-	do
-		i = xrnd() % 7;
-	while (colFull(i));
+	t = GetTime();
 
-	return i;
+	return ((t >> 16) & 0xFF) * 3600L + ((t >> 8) & 0xFF) * 60L + (t & 0xFF);
 }
 
-// Check for 2 connected chips
-int getMove2(void)
+bool timeUp(void)
 {
-	int row, col;
+	long t;
+
+	t = now();
+
+	if (t < deadline - 43200L)	// past midnight
+		t += 86400L;
+
+	return (t >= deadline);
+}
+#endif
+
+// Negamax search with alpha-beta pruning
+// returns the score from the point of view of the side to move
+int negamax(char depth, int alpha, int beta, char ply)
+{
+	int i, score, best, alpha0;
+	char col, bestMove, ttMove;
+	struct tte *e;
+
+	nodes++;
+#ifdef Z80ALL
+	if (seconds && rootDepth > 1 && (nodes & 0xFF) == 0 && timeUp())
+		aborted = TRUE;
+#endif
+	if (aborted)
+		return 0;
+
+	// a win for the side to move ends the search here
+	for (i = 0; i < COLS; i++)
+		if (height[i] < ROWS && winsAt(i))
+			return WIN - ply - 1;
+
+	if (moves >= ROWS*COLS - 1)
+		return 0;	// draw, the last chip cannot win
+
+	if (depth == 0)
+		return points[side] - points[side ^ 1];
+
+	alpha0 = alpha;
+	ttMove = -1;
+	e = &tt[hash & (TTSIZE-1)];
+
+	if (e->flag && e->lock == lock)
+	{
+		ttMove = e->move;
+
+		if (e->depth >= depth)
+		{
+			score = e->score;
+
+			// wins are stored relative to this position
+			if (score > WIN - MAXPLY)
+				score -= ply;
+			else if (score < MAXPLY - WIN)
+				score += ply;
+
+			if (e->flag == TT_EXACT)
+				return score;
+
+			if (e->flag == TT_LOWER && score >= beta)
+				return score;
+
+			if (e->flag == TT_UPPER && score <= alpha)
+				return score;
+		}
+	}
+
+	best = -INF;
+	bestMove = order[0];
 
-	for (row = 0; row < ROWS; row++)
+	for (i = -1; i < COLS; i++)
 	{
-		for (col = 0; col < COLS; col++)
+		if (i < 0)
+		{
+			if (ttMove < 0)
+				continue;
+
+			col = ttMove;
+		}
+		else
 		{
-			if (board[row][col] == 'O')
+			col = order[i];
+
+			if (col == ttMove)
+				continue;
+		}
+
+		if (height[col] == ROWS)
+			continue;
+
+		make(col);
+		score = -negamax(depth - 1, -beta, -alpha, ply + 1);
+		unmake(col);
+
+		if (aborted)
+			return 0;
+
+		if (score > best)
+		{
+			best = score;
+			bestMove = col;
+
+			if (score > alpha)
 			{
-				//   O
-				//row O
-				//    c
-				//    o
-				//    l
-
-				if (col >= 2 && row >= 2) 
-				{
-					if (board[row-1][col-1] == 'O')
-					{
-						if (board[row-2][col-2] == ' ' && board[row-1][col-2] != ' ') 
-						{
-							if (!colFull(col-2))
-								return col-2;
-						}
-					}
-				}
-
-				//row O
-				//   Oc
-				//    o
-				//    l
-
-				if (col >= 2 && row < ROWS-2) 
-				{
-					if (board[row+1][col-1] == 'O')
-					{
-						if (board[row+2][col-2] == ' ') 
-						{
-							if (row >= ROWS-3) 
-							{
-								if (!colFull(col-2))
-									return col-2;
-							}
-							else if (board[row+3][col-2] != ' ') 
-							{
-								if (!colFull(col-2))
-									return col-2;
-							}
-						}
-					}
-				}
-
-				//     
-				//    O
-				//row O
-				//    c
-				//    o
-				//    l
-
-				if (row >= 2 && board[row-2][col] == ' ' && board[row-1][col] == 'O') 
-				{
-					if (!colFull(col))
-						return col;
-				}
-
-				//  OO row
-				//   c
-				//   o
-				//   l
-
-				if (col >= 2 && board[row][col-2] == ' ' && board[row][col-1] == 'O')
-				{
-					if (row == ROWS-1) 
-					{
-						if (!colFull(col-2))
-							return col-2;
-					}
-					else if (board[row+1][col-2] != ' ')
-					{
-						if (!colFull(col-2))
-							return col-2;
-					}
-				}
-
-				//   OO row
-				//   c
-				//   o
-				//   l
-
-				if (col < COLS-2 && board[row][col+1] == 'O' && board[row][col+2] == ' ')
-				{
-					if (row == ROWS-1) 
-					{
-						if (!colFull(col+2))
-							return col+2;
-					}
-					else if (board[row+1][col+2] != ' ')
-					{
-						if (!colFull(col+2))
-							return col+2;
-					}
-				}
+				alpha = score;
+
+				if (alpha >= beta)
+					break;
 			}
 		}
 	}
 
-	// no match, pick randomly a non-full column
-	return randomInt();
+	// always replace
+	e->lock = lock;
+	e->depth = depth;
+	e->move = bestMove;
+
+	if (best <= alpha0)
+		e->flag = TT_UPPER;
+	else if (best >= beta)
+		e->flag = TT_LOWER;
+	else
+		e->flag = TT_EXACT;
+
+	score = best;
+
+	if (score > WIN - MAXPLY)
+		score += ply;
+	else if (score < MAXPLY - WIN)
+		score -= ply;
+
+	e->score = score;
+
+	return best;
 }
 
-// Check for 3 connected chips (part II)
-int getMove3b(void)
+// Computer's move, by iterative deepening
+// stops at maxDepth, when the time is up, or when the game result is known
+int getMove(void)
 {
-	int row, col;
+	int i, score, alpha;
+	char col, best, cur, depth;
+
+	for (i = 0; i < COLS; i++)
+		if (height[i] < ROWS && winsAt(i))
+		{
+			rootDepth = 1;
+			return i;
+		}
+
+	nodes = 0;
+	aborted = FALSE;
+	best = -1;
 
-	for (row = 0; row < ROWS; row++)
+#ifdef Z80ALL
+	if (seconds)
+		deadline = now() + seconds;
+#endif
+
+	for (depth = 1; depth <= maxDepth && depth <= ROWS*COLS - moves; depth++)
 	{
-		for (col = 0; col < COLS; col++)
+		rootDepth = depth;
+		alpha = -INF;
+		cur = -1;
+
+		for (i = -1; i < COLS; i++)
 		{
-			if (board[row][col] == 'O')
+			if (i < 0)
 			{
-				// OO O row
-				//    c
-				//    o
-				//    l
-
-				// O OO row
-				//    c
-				//    o
-				//    l
-
-				if (col >= 3 && board[row][col-3] == 'O') 
-				{
-					if (board[row][col-2] == 'O') 
-					{
-						if (row = ROWS-1)
- 						{
-							if (!colFull(col-1))
-								return col-1;
-						} 
-						else if (board[row+1][col-1] != ' ')
-						{
-							if (!colFull(col-1))
-								return col-1;
-						}
-					}
-					else if (board[row][col-1] == 'O')
-					{
-						if (row = ROWS-1) 
-						{
-							if (!colFull(col-2))
-								return col-2;
-						} 
-						else if (board[row+1][col-2] != ' ') 
-						{
-							if (!colFull(col-2))
-								return col-2;
-						}
-					}
-				}
-
-				//O   c
-				// O  o
-				//    l
-				//row O
-
-				//O   c
-				//    o
-				//   Ol
-				//row O
-
-				if (col >= 3 && row >= 3) 
-				{
-					if (board[row-3][col-3] == 'O')
-					{
-						if (board[row-2][col-2] == 'O') 
-						{
-							if (board[row-1][col-1] == ' ' && board[row][col-1] != ' ') 
-							{
-								if (!colFull(col-1))
-									return col-1;
-							}
-						}
-						else if (board[row-1][col-1] == 'O') 
-						{
-							if (board[row-2][col-2] == ' ' && board[row-1][col-2] != ' ') 
-							{
-								if (!colFull(col-2))
-									return col-2;
-							}
-						}
-					}
-				}
-
-				//c  O
-				//o O
-				//l
-				//O row
-
-				//c  O
-				//o 
-				//lO
-				//O row
-
-				if (col < COLS-3 && row >= 3) 
-				{
-					if (board[row-3][col+3] == 'O')
-					{
-						if (board[row-2][col+2] == 'O') 
-						{
-							if (board[row-1][col+1] == ' ' && board[row][col+1] != ' ') 
-							{
-								if (!colFull(col+1))
-									return col+1;
-							}
-						}
-						else if (board[row-1][col+1] == 'O') 
-						{
-							if (board[row-2][col+2] == ' ' && board[row-1][col+2] != ' ') 
-							{
-								if (!colFull(col+2))
-									return col+2;
-							}
-						}
-					}
-				}
+				if (best < 0)
+					continue;
+
+				col = best;	// previous iteration's choice first
 			}
+			else
+			{
+				col = order[i];
+
+				if (col == best)
+					continue;
+			}
+
+			if (height[col] == ROWS)
+				continue;
+
+			make(col);
+			score = -negamax(depth - 1, -INF, -alpha, 1);
+			unmake(col);
+
+			if (aborted)
+				break;
+
+			if (score > alpha)
+			{
+				alpha = score;
+				cur = col;
+			}
+		}
+
+		if (aborted)
+		{
+			rootDepth = depth - 1;
+			break;
 		}
+
+		best = cur;
+
+		if (alpha > WIN - MAXPLY || alpha < MAXPLY - WIN)
+			break;
+
+#ifdef Z80ALL
+		if (seconds && timeUp())
+			break;
+#endif
 	}
 
-	// no match, try to find 2 connected chips...
-	return getMove2();
+	return best;
 }
 
-// Check for 3 connected chips (part I)
-int getMove3a(void)
+// Ask for depth or time per move
+void choose_level(void)
 {
-	int row, col;
+	char c;
+
+	sprintf(line, "\r\nSearch depth (1 to %d)", MAXDEPTH);
+	printf(line);
+#ifdef Z80ALL
+	printf(", or T for time per move");
+#endif
+	printf(" : ");
 
-	for (row = 0; row < ROWS; row++)
+	do
 	{
-		for (col = 0; col < COLS; col++)
-		{
-			if (board[row][col] == 'O')
-			{
-				//
-				//  O
-				//   O
-				//row O
-				//    c
-				//    o
-				//    l
-
-				if (col >= 3 && row >= 3) 
-				{
-					if (board[row-1][col-1] == 'O' && board[row-2][col-2] == 'O')
-					{
-						if (board[row-3][col-3] == ' ' && board[row-2][col-3] != ' ') 
-						{
-							if (!colFull(col-3))
-								return col-3;
-						}
-					}
-				}
-
-				if (col >= 2 && col < COLS-1 && row >= 2 && row < ROWS-2) 
-				{
-					if (board[row-1][col-1] == 'O' && board[row-2][col-2] == 'O')
-					{
-						if (board[row+1][col+1] == ' ' && board[row+2][col+1] != ' ') 
-						{
-							if (!colFull(col+1))
-								return col+1;
-						}
-					}
-				}
-
-				//row O
-				//   Oc
-				//  O o
-				//    l
-
-				if (col >= 3 && row < ROWS-3) 
-				{
-					if (board[row+1][col-1] == 'O' && board[row+2][col-2] == 'O')
-					{
-						if (board[row+3][col-3] == ' ') 
-						{
-							if (row == ROWS-4) 
-							{
-								if (!colFull(col-3))
-									return col-3;
-							}
-							else if (board[row+4][col-3] != ' ') 
-							{
-								if (!colFull(col-3))
-									return col-3;
-							}
-						}
-					}
-				}
-
-				if (col >= 2 && col < COLS-1 && row >= 1 && row < ROWS-2) 
-				{
-					if (board[row+1][col-1] == 'O' && board[row+2][col-2] == 'O')
-					{
-						if (board[row-1][col+1] == ' ') 
-						{
-							if (board[row][col+1] != ' ') 
-							{
-								if (!colFull(col+1))
-									return col+1;
-							}
-						}
-					}
-				}
-
-				//
-				//    O
-				//    O
-				//row O
-				//    c
-				//    o
-				//    l
-
-				if (row >= 3 && board[row-3][col] == ' ' && board[row-2][col] == 'O' && board[row-1][col] == 'O') 
-				{
-					if (!colFull(col))
-						return col;
-				}
-
-				// OOO row
-				//   c
-				//   o
-				//   l
-
-				if (col >= 3 && board[row][col-3] == ' ' && board[row][col-2] == 'O' && board[row][col-1] == 'O')
-				{
-					if (row == ROWS-1) 
-					{
-						if (!colFull(col-3))
-							return col-3;
-					}
-					else if (board[row+1][col-3] != ' ')
-					{
-						if (!colFull(col-3))
-							return col-3;
-					}
-				}
-
-				//   OOO row
-				//   c
-				//   o
-				//   l
-
-				if (col < COLS-3 && board[row][col+1] == 'O' && board[row][col+2] == 'O' && board[row][col+3] == ' ')
-				{
-					if (row == ROWS-1) 
-					{
-						if (!colFull(col+3))
-							return col+3;
-					}
-					else if (board[row+1][col+3] != ' ')
-					{
-						if (!colFull(col+3))
-							return col+3;
-					}
-				}
-			}
-		}
+		c = GETCH();
+
+		if (isascii(c))
+			c = toupper(c);
 	}
+#ifdef Z80ALL
+	while (c != 'T' && (!isdigit(c) || c == '0' || c > '0' + MAXDEPTH));
+#else
+	while (!isdigit(c) || c == '0' || c > '0' + MAXDEPTH);
+#endif
 
-	return getMove3b();
+	putchar(c);
+
+	if (c != 'T')
+	{
+		maxDepth = c - '0';
+		seconds = 0;
+		return;
+	}
+
+	printf("\r\nSeconds per move (1 to 9) : ");
+
+	do
+		c = GETCH();
+	while (!isdigit(c) || c == '0');
+
+	putchar(c);
+
+	seconds = c - '0';
+	maxDepth = MAXPLY;
 }
 
 // player 	O
@@ -586,6 +677,8 @@ void main(void)
 	char c;
 
 	xrndseed();
+	init_hash();
+	init_lines();
 
 	// init board (fill-it with blanks)
 	for (i = 0; i < ROWS; i++)
@@ -600,15 +693,18 @@ void main(void)
 		" seven-column vertically suspended grid. The pieces fall\r\n"
 		" straight down, occupying the lowest available space.\r\n"
 		"To win, a player must form a horizontal, vertical or diagonal\r\n"
-		" line of four of his own chips. Use Ctrl^C to quit...\r\n\r\n");
+		" line of four of his own chips. Use Ctrl^C to quit...\r\n");
+
+	choose_level();
 
-	printf("Do you want to move first? (Y/y = yes) : ");
+	printf("\r\nDo you want to move first? (Y/y = yes) : ");
 	c = GETCH();
 
 	if (isascii(c))
 		c = toupper(c);
-	
+
 	toMove = (c == 'Y') ? 'O' : 'X';
+	side = (toMove == 'O') ? 0 : 1;
 
 	while (1)
 	{
@@ -637,13 +733,14 @@ again:
 			toMove = 'X';
 		}
 		else
-		{	
+		{
 			gotoxy(15,0);
 			eraseToEOS();
 
-			c = getMove3a();
-			
-			printf("Computer drops a chip into the column %d...", c+1);
+			c = getMove();
+
+			sprintf(line, "Computer drops a chip into the column %d (depth %d)...", c+1, rootDepth);
+			printf(line);
 
 			place_chip(c);	// no need to check 'column full'
 
@@ -659,8 +756,8 @@ again:
 		{
 			gotoxy(15, 0);
 			eraseToEOS();
-			printf("You %s!", (c == 'O') ? "won" : "lost");
-			exit(1);
+			printf((c == 'O') ? "You won!" : "You lost!");
+			quit();
 		}
 
 		if (isFull())
@@ -668,7 +765,7 @@ again:
 			gotoxy(15, 0);
 			eraseToEOS();
 			printf("It's a draw (all columns are full) !");
-			exit(1);
+			quit();
 		}
 	}
 }
@@ -0,0 +1,28 @@
+void	Clear(void);				/* fills the screen with blanks */
+
+/* Y = 0...47 bottom to top, X = 0...63 left to right */
+
+void	PrintChar(int Y, int X, char ch);
+void	PrintStr(int Y, int X, char* p);	/* zero terminated */
+void	PrintStrN(int Y, int X, char* p, int n);	/* n chars (0...255) */
+void	HLine(int Y, int X, int n, char ch);	/* n chars to the right */
+void	VLine(int Y, int X, int n, char ch);	/* n chars downwards */
+
+/* (Y,X) is the top-left corner, h rows of w chars */
+
+void	FillRect(int Y, int X, int h, int w, char ch);
+void	PutBlock(int Y, int X, int h, int w, char* p);	/* p -> screen */
+void	GetBlock(int Y, int X, int h, int w, char* p);	/* screen -> p */
+
+/* console: text at a cursor, row = 0...47 top to bottom, col = 0...63 */
+/* CR, LF, BS & BEL as on the BIOS VT52 terminal, no scrolling */
+
+void	VClear(void);			/* cursor at (0,0) */
+void	VLocate(int row, int col);
+void	VPutc(char c);
+void	VPuts(char* p);
+void	VRun(char c, int n);		/* n times c */
+void	VClearEOL(void);		/* cursor not moved */
+void	VClearEOS(void);		/* cursor not moved */
+void	VReverse(char on);		/* 1 = reverse video */
+void	VSync(void);			/* BIOS cursor to the console cursor */
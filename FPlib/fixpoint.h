@@ -0,0 +1,13 @@
+/* Fixed point 8.8 : high byte = integer part, low byte = fraction */
+
+int	mul(int fp1, int fp2);	/* fp1 * fp2 */
+int	div(int fp1, int fp2);	/* fp1 / fp2 */
+int	neg(int fp);		/* -fp */
+int	positive(int fp);	/* |fp| */
+
+int	sin(int fp);		/* angle in radians, any sign */
+int	cos(int fp);		/* from a quarter wave table, interpolated */
+int	arctan(int fp);		/* fp >= 0, from a table on [0,1] */
+int	fpsqrt(int fp);		/* fp unsigned, rounded bitwise root */
+
+int	xdivytofp(int x, int y);	/* x / y (x < y) as a fraction */
@@ -0,0 +1,258 @@
+// Benchmark of the fixed point math library
+//
+// sin, cos, arctan & fpsqrt from fixpoint.as (tables, bitwise root)
+// against the older polynomial & Newton routines kept in fpold.as :
+//  - largest and mean error, in 1/256, against a 1/16384 reference
+//  - calls per second, from the DS1302 seconds (GetSeconds, nothing
+//    printed), each routine being run for SECONDS seconds
+//
+//	fpbench [MHz]	(with the CPU clock, also shows T-states per call)
+//
+#include <stdio.h>
+#include <stdlib.h>
+
+int sin(int);
+int cos(int);
+int arctan(int);
+int fpsqrt(int);
+
+int osin(int);
+int ocos(int);
+int oarctan(int);
+int ofpsqrt(int);
+
+char GetSeconds(void);
+
+#define twoPI	0x648	// fp 2*PI
+
+#define Q	16384L	// reference scale (1/16384)
+#define QPI	51472L	// PI, in 1/16384
+#define QHALFPI	25736L
+
+#define SECONDS	20	// time of each timing loop
+
+typedef int (*fpfunc)(int);
+
+int mhz;
+
+struct test
+{
+	char *name;
+	fpfunc fnew, fold;
+	int first, last, step;	// inputs
+};
+
+int nop(int x)
+{
+	return x;
+}
+
+// sin(a), a on [0,PI/2] in 1/16384, Taylor series up to a^11
+long qsin(long a)
+{
+	long s, t;
+	int k;
+
+	s = t = a;
+
+	for (k = 2; k <= 10; k += 2)
+	{
+		t = -(t * a / Q) * a / Q / (k * (k + 1));
+		s += t;
+	}
+
+	return s;
+}
+
+// sin(a), a >= 0 in 1/16384
+long rsin(long a)
+{
+	a %= 2 * QPI;
+
+	if (a >= QPI)
+		return -rsin(a - QPI);
+
+	if (a > QHALFPI)
+		a = QPI - a;
+
+	return qsin(a);
+}
+
+// arctan(x), x in 1/256, by bisection on sin(a) = x * cos(a)
+long ratan(long x)
+{
+	long lo = 0, hi = QHALFPI, mid;
+
+	while (hi - lo > 1)
+	{
+		mid = (lo + hi) / 2;
+
+		if (qsin(mid) * 256 < x * qsin(QHALFPI - mid))
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+// sqrt(x / 256) in 1/16384 = sqrt(x * 65536) * 4
+long rsqrt(unsigned int x)
+{
+	unsigned long v = (unsigned long)x << 16, r = 0, b = 1L << 30;
+
+	while (b > v)
+		b >>= 2;
+
+	while (b)
+	{
+		if (v >= r + b)
+		{
+			v -= r + b;
+			r = (r >> 1) + b;
+		}
+		else
+			r >>= 1;
+		b >>= 2;
+	}
+
+	return r * 4;
+}
+
+long reference(int n, int x)
+{
+	switch (n)
+	{
+		case 0:	return rsin((long)x * 64);
+		case 1:	return rsin((long)x * 64 + QHALFPI);
+		case 2:	return ratan((long)x);
+		default: return rsqrt((unsigned int)x);
+	}
+}
+
+struct test tests[4] =
+{
+	{ "sin",    sin,    osin,    0, twoPI - 1, 2 },
+	{ "cos",    cos,    ocos,    0, twoPI - 1, 2 },
+	{ "arctan", arctan, oarctan, 0, 0x7F00,    0x40 },
+	{ "fpsqrt", fpsqrt, ofpsqrt, 0, 0x7F00,    0x20 },
+};
+
+// the DS1302 seconds, from BCD
+int second(void)
+{
+	char s;
+
+	s = GetSeconds();
+	return (s >> 4) * 10 + (s & 0x0F);
+}
+
+// loops of f over the inputs, from a tick of the clock until SECONDS
+// have passed: *s is the time taken, within one loop
+long timeit(struct test *t, fpfunc f, long *s)
+{
+	long loops = 0;
+	int last, now, x;
+
+	last = second();
+
+	while (second() == last)
+		;
+
+	last = second();
+	*s = 0;
+
+	do
+	{
+		for (x = t->first; x <= t->last; x += t->step)
+			f(x);
+
+		loops++;
+		now = second();
+		*s += (now - last + 60) % 60;
+		last = now;
+	}
+	while (*s < SECONDS);
+
+	return loops;
+}
+
+// error of f on the inputs, in 1/100 of 1/256
+void accuracy(int n, struct test *t, fpfunc f, long *ref, long *maxerr, long *meanerr)
+{
+	long e, sum = 0;
+	int i = 0, x;
+
+	*maxerr = 0;
+
+	for (x = t->first; x <= t->last; x += t->step)
+	{
+		e = (long)f(x) * (Q / 256) - ref[i++];
+
+		if (e < 0)
+			e = -e;
+
+		if (e > *maxerr)
+			*maxerr = e;
+
+		sum += e;
+	}
+
+	*maxerr = *maxerr * 100 / (Q / 256);
+	*meanerr = sum * 100 / (Q / 256) / i;
+}
+
+// T-states per call, or 0 : calls in s seconds
+long tstates(long s, long calls)
+{
+	return mhz ? s * mhz * 1000000L / calls : 0;
+}
+
+void report(char *name, long maxerr, long meanerr, long s, long calls, long base)
+{
+	printf("  %-8s error max %ld.%02ld mean %ld.%02ld, %ld calls/s",
+		name, maxerr / 100, maxerr % 100, meanerr / 100, meanerr % 100,
+		calls / s);
+
+	if (mhz)	// less the loop
+		printf(", %ld T-states", tstates(s, calls) - base);
+
+	printf("\r\n");
+}
+
+void main(int argc, char **argv)
+{
+	struct test *t;
+	long *ref, calls, base, maxerr, meanerr, s;
+	int n, i, x;
+
+	if (argc > 1)
+		mhz = atoi(argv[1]);
+
+	ref = (long *)malloc(1024 * sizeof(long));
+
+	printf("fixpoint.as (new) against fpold.as (old), %d s each\r\n", SECONDS);
+
+	for (n = 0; n < 4; n++)
+	{
+		t = &tests[n];
+
+		printf("%s: reference...", t->name);
+
+		for (i = 0, x = t->first; x <= t->last; x += t->step)
+			ref[i++] = reference(n, x);
+
+		calls = timeit(t, nop, &s) * i;
+		base = tstates(s, calls);
+
+		printf(" %d inputs, loop alone %ld calls/s\r\n", i, calls / s);
+
+		accuracy(n, t, t->fnew, ref, &maxerr, &meanerr);
+		calls = timeit(t, t->fnew, &s) * i;
+		report("new", maxerr, meanerr, s, calls, base);
+
+		accuracy(n, t, t->fold, ref, &maxerr, &meanerr);
+		calls = timeit(t, t->fold, &s) * i;
+		report("old", maxerr, meanerr, s, calls, base);
+	}
+}
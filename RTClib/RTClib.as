@@ -3,6 +3,7 @@
 ;
 	global	_InitRTC
 	global	_GetTime
+	global	_GetSeconds
 	global	_GetStartTime
 	global	_GetStopTime
 	global	_PrintLapseTime
@@ -579,6 +580,19 @@ _GetTime:
 	CALL	ResetON		; turn RTC reset back on 
 	RET				; Yes, end function and return
 ;
+;char	GetSeconds(void)
+;
+;	returns L = seconds (BCD), nothing written on screen
+;	used to count the frames shown in one second
+;
+_GetSeconds:
+	LD	D,00H			; seconds register
+	CALL	RTC_READ		; C = ?SSSssss
+	LD	A,C
+	AND	7FH			; discard clock halt flag
+	LD	L,A
+	RET
+;
 Delay:
 	PUSH	AF			; 11 t-states
 	LD	A,7			; 7 t-states ADJUST THE TIME 13h IS FOR 4 MHZ
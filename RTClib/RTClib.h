@@ -5,6 +5,9 @@ long	GetTime(void); 	/* writes HH:MM:SS to the top-right corner of the screen */
 			/* current cursor position on screen NOT affected */
 			/* returns E = seconds, D = minutes, L = hours, H = 0 */
 
+char	GetSeconds(void);	/* returns the seconds (BCD), writes nothing */
+				/* used to pace games in real time */
+
 void	GetStartTime(void); 	/* get current time (hour,minute,seconds) */
 				/* and store-it in StartTime */
 void	GetStopTime(void);	/* get current time (hour,minute,seconds) */
@@ -0,0 +1,614 @@
+;
+;	Z80ALL VGA text screen library (64 x 48)
+;
+;	The screen is written through the I/O ports: C = group of 4 rows
+;	(0...0BH, from the top), B = 64 x (row in the group) + column.
+;	The group & offset of each row are read from rowtab; runs of chars
+;	(strings, lines, rectangles, blocks) compute the address once, then
+;	step it : +1 for the next column, +64 (carry into C) for the row below
+;
+;	Y = 0...47 bottom to top, X = 0...63 left to right
+;	(as PrintChar & PrintStr in pool and balls)
+;
+	global	_Clear
+	global	_PrintChar
+	global	_PrintStr
+	global	_PrintStrN
+	global	_HLine
+	global	_VLine
+	global	_FillRect
+	global	_PutBlock
+	global	_GetBlock
+	global	_VClear
+	global	_VLocate
+	global	_VPutc
+	global	_VPuts
+	global	_VRun
+	global	_VClearEOL
+	global	_VClearEOS
+	global	_VReverse
+	global	_VSync
+
+CR	equ	0DH
+LF	equ	0AH
+BS	equ	8
+BEL	equ	7
+BDOS	equ	5
+
+	psect	data
+;
+;	group (C), offset (B) of the first column, for each Y
+;
+rowtab:
+	defb	0BH,0C0H		;Y=0
+	defb	0BH,080H		;Y=1
+	defb	0BH,040H		;Y=2
+	defb	0BH,000H		;Y=3
+	defb	0AH,0C0H		;Y=4
+	defb	0AH,080H		;Y=5
+	defb	0AH,040H		;Y=6
+	defb	0AH,000H		;Y=7
+	defb	09H,0C0H		;Y=8
+	defb	09H,080H		;Y=9
+	defb	09H,040H		;Y=10
+	defb	09H,000H		;Y=11
+	defb	08H,0C0H		;Y=12
+	defb	08H,080H		;Y=13
+	defb	08H,040H		;Y=14
+	defb	08H,000H		;Y=15
+	defb	07H,0C0H		;Y=16
+	defb	07H,080H		;Y=17
+	defb	07H,040H		;Y=18
+	defb	07H,000H		;Y=19
+	defb	06H,0C0H		;Y=20
+	defb	06H,080H		;Y=21
+	defb	06H,040H		;Y=22
+	defb	06H,000H		;Y=23
+	defb	05H,0C0H		;Y=24
+	defb	05H,080H		;Y=25
+	defb	05H,040H		;Y=26
+	defb	05H,000H		;Y=27
+	defb	04H,0C0H		;Y=28
+	defb	04H,080H		;Y=29
+	defb	04H,040H		;Y=30
+	defb	04H,000H		;Y=31
+	defb	03H,0C0H		;Y=32
+	defb	03H,080H		;Y=33
+	defb	03H,040H		;Y=34
+	defb	03H,000H		;Y=35
+	defb	02H,0C0H		;Y=36
+	defb	02H,080H		;Y=37
+	defb	02H,040H		;Y=38
+	defb	02H,000H		;Y=39
+	defb	01H,0C0H		;Y=40
+	defb	01H,080H		;Y=41
+	defb	01H,040H		;Y=42
+	defb	01H,000H		;Y=43
+	defb	00H,0C0H		;Y=44
+	defb	00H,080H		;Y=45
+	defb	00H,040H		;Y=46
+	defb	00H,000H		;Y=47
+
+VCursor:defw	0		;console cursor : C=group, B=offset
+VRev:	defb	0		;00=video normal, 80H=video reverse
+
+	psect	text
+;
+;	HL = pointer to the Y, X arguments
+;	returns BC = port & address of (Y,X), HL = pointer to the next argument
+;	uses A, DE
+;
+yxaddr:
+	ld	a,(hl)		;A=Y
+	inc	hl
+	inc	hl
+	ld	e,(hl)		;E=X
+	inc	hl
+	inc	hl
+	push	hl
+	ld	l,a
+	ld	h,0
+	add	hl,hl
+	ld	bc,rowtab
+	add	hl,bc
+	ld	c,(hl)		;C=group
+	inc	hl
+	ld	a,(hl)
+	add	a,e
+	ld	b,a		;B=offset
+	pop	hl
+	ret
+;
+;void	Clear(void)
+;
+_Clear:
+	ld	a,' '
+	ld	bc,0BH		;last group of 4 lines, first column
+1:
+	out	(c),a		;4 chars per loop
+	dec	b
+	out	(c),a
+	dec	b
+	out	(c),a
+	dec	b
+	out	(c),a
+	djnz	1b
+	dec	c		;previous group
+	jp	p,1b		;if C >= 0 , repeat
+	ret
+;
+;void	PrintChar(int Y, int X, char ch)
+;
+_PrintChar:
+	ld	hl,2
+	add	hl,sp
+	call	yxaddr
+	ld	a,(hl)		;A=ch
+	out	(c),a
+	ret
+;
+;void	PrintStr(int Y, int X, char* p)
+;
+_PrintStr:
+	ld	hl,2
+	add	hl,sp
+	call	yxaddr
+	ld	a,(hl)
+	inc	hl
+	ld	h,(hl)
+	ld	l,a		;HL=p
+1:
+	ld	a,(hl)
+	or	a
+	ret	z
+	out	(c),a
+	inc	hl
+	inc	b
+	jr	1b
+;
+;void	PrintStrN(int Y, int X, char* p, int n)
+;
+;	prints n (0...255) chars, from the last one: OUTD decrements B
+;	before the output
+;
+_PrintStrN:
+	ld	hl,2
+	add	hl,sp
+	call	yxaddr
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)		;DE=p
+	inc	hl
+	ld	a,(hl)		;A=n
+	or	a
+	ret	z
+	ld	l,a
+	ld	h,0
+	add	hl,de
+	dec	hl		;HL=last char
+	ld	e,a		;E=counter
+	add	a,b
+	ld	b,a		;B=offset after the last char
+1:
+	outd			;B-1, out (C),(HL), HL-1
+	dec	e
+	jr	nz,1b
+	ret
+;
+;void	HLine(int Y, int X, int n, char ch)
+;
+;	n chars to the right
+;
+_HLine:
+	ld	hl,2
+	add	hl,sp
+	call	yxaddr
+	ld	e,(hl)		;E=n
+	inc	hl
+	inc	hl
+	ld	a,(hl)		;A=ch
+	inc	e
+	dec	e
+	ret	z
+1:
+	out	(c),a
+	inc	b
+	dec	e
+	jr	nz,1b
+	ret
+;
+;void	VLine(int Y, int X, int n, char ch)
+;
+;	n chars downwards (Y, Y-1, ...)
+;
+_VLine:
+	ld	hl,2
+	add	hl,sp
+	call	yxaddr
+	ld	e,(hl)		;E=n
+	inc	hl
+	inc	hl
+	ld	d,(hl)		;D=ch
+	inc	e
+	dec	e
+	ret	z
+1:
+	ld	a,d
+	out	(c),a
+	ld	a,b
+	add	a,64		;row below
+	ld	b,a
+	jr	nc,2f
+	inc	c		;next group
+2:
+	dec	e
+	jr	nz,1b
+	ret
+;
+;void	FillRect(int Y, int X, int h, int w, char ch)
+;
+;	h rows of w chars, (Y,X) is the top-left corner
+;
+_FillRect:
+	ld	hl,2
+	add	hl,sp
+	call	yxaddr
+	ld	d,(hl)		;D=h
+	inc	hl
+	inc	hl
+	ld	e,(hl)		;E=w
+	inc	hl
+	inc	hl
+	ld	h,(hl)		;H=ch
+	ld	l,e		;L=w
+	inc	d
+	dec	d
+	ret	z
+	inc	e
+	dec	e
+	ret	z
+1:
+	push	bc
+	ld	a,h
+2:
+	out	(c),a
+	inc	b
+	dec	e
+	jr	nz,2b
+	pop	bc
+	ld	e,l
+	ld	a,b
+	add	a,64		;row below
+	ld	b,a
+	jr	nc,3f
+	inc	c		;next group
+3:
+	dec	d
+	jr	nz,1b
+	ret
+;
+;	HL = pointer to the h, w, p arguments (after Y, X)
+;	returns D = h, E = w, HL = p, Z set if h or w is 0
+;
+blkargs:
+	ld	d,(hl)		;D=h
+	inc	hl
+	inc	hl
+	ld	e,(hl)		;E=w
+	inc	hl
+	inc	hl
+	ld	a,(hl)
+	inc	hl
+	ld	h,(hl)
+	ld	l,a		;HL=p
+	inc	d
+	dec	d
+	ret	z
+	inc	e
+	dec	e
+	ret
+;
+;void	PutBlock(int Y, int X, int h, int w, char* p)
+;
+;	copies h rows of w chars from p (row after row) to the screen,
+;	(Y,X) is the top-left corner
+;
+_PutBlock:
+	ld	hl,2
+	add	hl,sp
+	call	yxaddr
+	call	blkargs
+	ret	z
+1:
+	push	de
+	push	bc
+2:
+	ld	a,(hl)
+	out	(c),a
+	inc	hl
+	inc	b
+	dec	e
+	jr	nz,2b
+	pop	bc
+	pop	de
+	ld	a,b
+	add	a,64		;row below
+	ld	b,a
+	jr	nc,3f
+	inc	c		;next group
+3:
+	dec	d
+	jr	nz,1b
+	ret
+;
+;void	GetBlock(int Y, int X, int h, int w, char* p)
+;
+;	copies h rows of w chars from the screen to p (row after row)
+;
+_GetBlock:
+	ld	hl,2
+	add	hl,sp
+	call	yxaddr
+	call	blkargs
+	ret	z
+1:
+	push	de
+	push	bc
+2:
+	in	a,(c)
+	ld	(hl),a
+	inc	hl
+	inc	b
+	dec	e
+	jr	nz,2b
+	pop	bc
+	pop	de
+	ld	a,b
+	add	a,64		;row below
+	ld	b,a
+	jr	nc,3f
+	inc	c		;next group
+3:
+	dec	d
+	jr	nz,1b
+	ret
+;
+;********************************************************************
+;	Console : text written at a cursor, as on the VT52 terminal of
+;	the BIOS (CR, LF, BS, BEL), but straight to the screen and without
+;	scrolling (LF on the last row does nothing)
+;
+;	row = 0...47 top to bottom, col = 0...63
+;
+;	A = row, E = col
+;	returns BC = port & address
+;
+rcaddr:
+	ld	c,a
+	rrca
+	rrca
+	and	0C0H		;64 x (row in the group)
+	add	a,e
+	ld	b,a		;B=offset
+	srl	c
+	srl	c		;C=group
+	ret
+;
+;void	VClear(void)
+;
+;	clears the screen, cursor at (0,0)
+;
+_VClear:
+	call	_Clear
+	ld	bc,0
+	ld	(VCursor),bc
+	ret
+;
+;void	VLocate(int row, int col)
+;
+_VLocate:
+	ld	hl,2
+	add	hl,sp
+	ld	a,(hl)		;A=row
+	inc	hl
+	inc	hl
+	ld	e,(hl)		;E=col
+	call	rcaddr
+	ld	(VCursor),bc
+	ret
+;
+;void	VPutc(char c)
+;
+_VPutc:
+	ld	hl,2
+	add	hl,sp
+	ld	a,(hl)		;A=char
+;
+;	A = char, uses A, BC, E (and all for BEL)
+;
+vputc:
+	ld	bc,(VCursor)
+	cp	' '
+	jr	c,ctrl
+	ld	e,a
+	ld	a,(VRev)
+	or	e
+	out	(c),a
+	inc	b		;next column
+	jr	nz,9f
+	ld	a,c		;next group
+	cp	0BH
+	jr	z,1f
+	inc	c
+	jr	9f
+1:
+	dec	b		;end of screen, stay there
+	jr	9f
+ctrl:
+	cp	CR
+	jr	nz,2f
+	ld	a,b
+	and	0C0H		;column 0
+	ld	b,a
+	jr	9f
+2:
+	cp	LF
+	jr	nz,3f
+	ld	a,b
+	add	a,64		;row below
+	jr	nc,1f
+	ld	e,a
+	ld	a,c
+	cp	0BH
+	ret	z		;last row
+	inc	c
+	ld	a,e
+1:
+	ld	b,a
+	jr	9f
+3:
+	cp	BS
+	jr	nz,4f
+	ld	a,b
+	and	3FH
+	ret	z		;column 0
+	dec	b
+	jr	9f
+4:
+	cp	BEL
+	ret	nz		;other control chars are ignored
+	ld	e,a
+	ld	c,2		;ring the bell
+	jp	BDOS
+9:
+	ld	(VCursor),bc
+	ret
+;
+;void	VPuts(char* p)
+;
+_VPuts:
+	ld	hl,2
+	add	hl,sp
+	ld	a,(hl)
+	inc	hl
+	ld	h,(hl)
+	ld	l,a		;HL=p
+1:
+	ld	a,(hl)
+	or	a
+	ret	z
+	push	hl
+	call	vputc
+	pop	hl
+	inc	hl
+	jr	1b
+;
+;void	VRun(char c, int n)
+;
+;	n times c, at the cursor
+;
+_VRun:
+	ld	hl,2
+	add	hl,sp
+	ld	d,(hl)		;D=char
+	inc	hl
+	inc	hl
+	ld	a,(hl)
+	inc	hl
+	ld	h,(hl)
+	ld	l,a		;HL=n
+1:
+	ld	a,h
+	or	l
+	ret	z
+	push	hl
+	push	de
+	ld	a,d
+	call	vputc
+	pop	de
+	pop	hl
+	dec	hl
+	jr	1b
+;
+;void	VClearEOL(void)
+;
+;	clears from the cursor to the end of the row, cursor not moved
+;
+_VClearEOL:
+	ld	bc,(VCursor)
+	ld	e,' '
+1:
+	out	(c),e
+	inc	b
+	ld	a,b
+	and	3FH
+	jr	nz,1b
+	ret
+;
+;void	VClearEOS(void)
+;
+;	clears from the cursor to the end of the screen, cursor not moved
+;
+_VClearEOS:
+	call	_VClearEOL	;B=next row
+	ld	a,b
+	or	a
+	jr	nz,1f
+	inc	c		;in the next group
+1:
+	ld	a,c
+	cp	0CH
+	ret	nc		;past the last group
+2:
+	out	(c),e
+	inc	b
+	jr	nz,2b
+	inc	c
+	jr	1b
+;
+;void	VReverse(char on)
+;
+_VReverse:
+	ld	hl,2
+	add	hl,sp
+	ld	a,(hl)
+	or	a
+	jr	z,1f
+	ld	a,80H
+1:
+	ld	(VRev),a
+	ret
+;
+;void	VSync(void)
+;
+;	moves the BIOS cursor to the console cursor (ESC Y row col),
+;	before writing through the BIOS again
+;
+_VSync:
+	ld	e,1BH
+	call	conout
+	ld	e,'Y'
+	call	conout
+	ld	bc,(VCursor)
+	ld	a,b
+	rlca
+	rlca
+	and	3		;row in the group
+	ld	e,a
+	ld	a,c
+	add	a,a
+	add	a,a
+	add	a,e		;row
+	add	a,32
+	ld	e,a
+	push	bc
+	call	conout
+	pop	bc
+	ld	a,b
+	and	3FH		;col
+	add	a,32
+	ld	e,a
+conout:
+	ld	c,2
+	jp	BDOS
+;
@@ -0,0 +1,340 @@
+// Benchmark of the VGA text screen library
+//
+// vga.as (row table, runs of chars) against the per game routines:
+//  - PrintChar & PrintStr from pool and balls (kept in vgaold.as)
+//  - CrtLocate, CharOut & StringOut from Tetris (vgadrive.as)
+//  - VT100 escape sequences through the BIOS (Connect4, sokoban, sudoku)
+// on the whole screen but the bottom line,
+// then a board redraw & text lines by the games (gotoxy + chars),
+// through the BIOS (VT52, VT100) and with the console (VLocate, VPutc),
+// from the DS1302 seconds (GetSeconds, nothing printed): each test is
+// repeated for SECONDS seconds, as the clock only counts whole seconds
+//
+//	vgabench
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include "vga.h"
+
+void OClear(void);
+void OPrintChar(int Y, int X, char ch);
+void OPrintStr(int Y, int X, char* p);
+
+void CrtClear(void);
+void CrtLocate(int row, int col);
+void CharOut(char c);
+void StringOut(char* p);
+
+char GetSeconds(void);
+
+#define ROWS	47	// Y = 1...47
+#define SECONDS	10	// time of each test
+
+#define BROWS	20	// game board: BROWS x BCELLS cells of 2 chars,
+#define BCELLS	20	// each one located first (as sokoban's mapchar)
+
+typedef void (*bench)(void);
+
+struct test
+{
+	char *name;
+	bench f;
+	long chars;	// written by one loop
+};
+
+char line[65];
+char block[ROWS * 64];
+
+void ch_new(void)
+{
+	int Y, X;
+
+	for (Y = 1; Y <= ROWS; Y++)
+		for (X = 0; X < 64; X++)
+			PrintChar(Y, X, 'a');
+}
+
+void ch_old(void)
+{
+	int Y, X;
+
+	for (Y = 1; Y <= ROWS; Y++)
+		for (X = 0; X < 64; X++)
+			OPrintChar(Y, X, 'b');
+}
+
+void ch_tetris(void)
+{
+	int Y, X;
+
+	for (Y = 1; Y <= ROWS; Y++)
+		for (X = 0; X < 64; X++)
+		{
+			CrtLocate(47 - Y, X);
+			CharOut('c');
+		}
+}
+
+void ch_vt100(void)
+{
+	int Y, X;
+
+	for (Y = 1; Y <= ROWS; Y++)
+		for (X = 0; X < 64; X++)
+			printf("%c[%d;%dHd", 27, 48 - Y, X + 1);
+}
+
+void str_new(void)
+{
+	int Y;
+
+	for (Y = 1; Y <= ROWS; Y++)
+		PrintStr(Y, 0, line);
+}
+
+void strn_new(void)
+{
+	int Y;
+
+	for (Y = 1; Y <= ROWS; Y++)
+		PrintStrN(Y, 0, line, 64);
+}
+
+void str_old(void)
+{
+	int Y;
+
+	for (Y = 1; Y <= ROWS; Y++)
+		OPrintStr(Y, 0, line);
+}
+
+void str_tetris(void)
+{
+	int Y;
+
+	for (Y = 1; Y <= ROWS; Y++)
+	{
+		CrtLocate(47 - Y, 0);
+		StringOut(line);
+	}
+}
+
+void str_vt100(void)
+{
+	int Y;
+
+	for (Y = 1; Y <= ROWS; Y++)
+		printf("%c[%d;1H%s", 27, 48 - Y, line);
+}
+
+void fill_new(void)
+{
+	FillRect(ROWS, 0, ROWS, 64, 'e');
+}
+
+void hline_new(void)
+{
+	int Y;
+
+	for (Y = 1; Y <= ROWS; Y++)
+		HLine(Y, 0, 64, 'f');
+}
+
+void vline_new(void)
+{
+	int X;
+
+	for (X = 0; X < 64; X++)
+		VLine(ROWS, X, ROWS, 'g');
+}
+
+void put_new(void)
+{
+	PutBlock(ROWS, 0, ROWS, 64, block);
+}
+
+void put_old(void)
+{
+	int Y, X;
+	char *p = block;
+
+	for (Y = ROWS; Y >= 1; Y--)
+		for (X = 0; X < 64; X++)
+			OPrintChar(Y, X, *p++);
+}
+
+void get_new(void)
+{
+	GetBlock(ROWS, 0, ROWS, 64, block);
+}
+
+void board_vga(void)
+{
+	int i, j;
+
+	for (i = 0; i < BROWS; i++)
+		for (j = 0; j < BCELLS; j++)
+		{
+			VLocate(i + 1, 2 * j + 24);
+			VPutc('[');
+			VPutc(']');
+		}
+}
+
+void board_vt52(void)
+{
+	int i, j;
+
+	for (i = 0; i < BROWS; i++)
+		for (j = 0; j < BCELLS; j++)
+		{
+			putchar(27); putchar('Y');
+			putchar(32 + i + 1);
+			putchar(32 + 2 * j + 24);
+			putchar('<');
+			putchar('>');
+		}
+}
+
+void board_vt100(void)
+{
+	int i, j;
+
+	for (i = 0; i < BROWS; i++)
+		for (j = 0; j < BCELLS; j++)
+			printf("%c[%d;%dH()", 27, i + 2, 2 * j + 25);
+}
+
+void lines_vga(void)
+{
+	int i;
+
+	for (i = 0; i < ROWS; i++)
+	{
+		VLocate(i, 0);
+		VPuts(line);
+	}
+}
+
+void lines_vt52(void)
+{
+	int i;
+
+	for (i = 0; i < ROWS; i++)
+	{
+		putchar(27); putchar('Y');
+		putchar(32 + i);
+		putchar(32);
+		printf("%s", line);
+	}
+}
+
+void clear_new(void)
+{
+	Clear();
+}
+
+void clear_old(void)
+{
+	OClear();
+}
+
+void clear_tetris(void)
+{
+	CrtClear();
+}
+
+struct test tests[] =
+{
+	{ "PrintChar   vga",	ch_new,		ROWS * 64L },
+	{ "PrintChar   pool",	ch_old,		ROWS * 64L },
+	{ "CharOut     tetris",	ch_tetris,	ROWS * 64L },
+	{ "char        VT100",	ch_vt100,	ROWS * 64L },
+	{ "PrintStr    vga",	str_new,	ROWS * 64L },
+	{ "PrintStrN   vga",	strn_new,	ROWS * 64L },
+	{ "PrintStr    pool",	str_old,	ROWS * 64L },
+	{ "StringOut   tetris",	str_tetris,	ROWS * 64L },
+	{ "string      VT100",	str_vt100,	ROWS * 64L },
+	{ "FillRect    vga",	fill_new,	ROWS * 64L },
+	{ "HLine       vga",	hline_new,	ROWS * 64L },
+	{ "VLine       vga",	vline_new,	ROWS * 64L },
+	{ "PutBlock    vga",	put_new,	ROWS * 64L },
+	{ "PrintChar's pool",	put_old,	ROWS * 64L },
+	{ "GetBlock    vga",	get_new,	ROWS * 64L },
+	{ "board       VLocate",	board_vga,	BROWS * BCELLS * 2L },
+	{ "board       VT52",	board_vt52,	BROWS * BCELLS * 2L },
+	{ "board       VT100",	board_vt100,	BROWS * BCELLS * 2L },
+	{ "lines       VPuts",	lines_vga,	ROWS * 64L },
+	{ "lines       VT52",	lines_vt52,	ROWS * 64L },
+	{ "Clear       vga",	clear_new,	48 * 64L },
+	{ "Clear       pool",	clear_old,	48 * 64L },
+	{ "CrtClear    tetris",	clear_tetris,	48 * 64L },
+};
+
+#define NTESTS	(sizeof(tests) / sizeof(struct test))
+
+// the DS1302 seconds, from BCD
+int second(void)
+{
+	char s;
+
+	s = GetSeconds();
+	return (s >> 4) * 10 + (s & 0x0F);
+}
+
+// loops of the test, from a tick of the clock until SECONDS
+// have passed: *s is the time taken, within one loop
+long timeit(struct test *t, long *s)
+{
+	long loops = 0;
+	int last, now;
+
+	last = second();
+
+	while (second() == last)
+		;
+
+	last = second();
+	*s = 0;
+
+	do
+	{
+		t->f();
+		loops++;
+		now = second();
+		*s += (now - last + 60) % 60;	// a loop takes less than 60 s
+		last = now;
+	}
+	while (*s < SECONDS);
+
+	return loops;
+}
+
+void main(void)
+{
+	long s[NTESTS], loops[NTESTS];
+	int n;
+
+	for (n = 0; n < 64; n++)
+		line[n] = 'A' + n % 26;
+
+	line[64] = 0;
+
+	for (n = 0; n < ROWS * 64; n++)
+		block[n] = 'a' + n % 26;
+
+	for (n = 0; n < NTESTS; n++)
+		loops[n] = timeit(&tests[n], &s[n]);
+
+	VClear();
+	VSync();	// the BIOS cursor home, as the console one
+
+	printf("vga.as against pool, tetris & VT100 output\r\n\n");
+
+	for (n = 0; n < NTESTS; n++)
+	{
+		printf("%-19s %5ld x %5ld chars, %3ld s, %7ld chars/s\r\n",
+			tests[n].name, loops[n], tests[n].chars, s[n],
+			loops[n] * tests[n].chars / s[n]);
+	}
+}
@@ -3,6 +3,7 @@
 ;
 	global	_InitRTC
 	global	_GetTime
+	global	_ReadTime
 	global	_GetStartTime
 	global	_GetStopTime
 	global	_PrintLapseTime
@@ -579,6 +580,52 @@ _GetTime:
 	CALL	ResetON		; turn RTC reset back on 
 	RET				; Yes, end function and return
 ;
+;long	ReadTime(void)
+;
+;	returns E = seconds
+;		D = minutes
+;		L = hours
+;		H = 0
+;	as GetTime, nothing written on screen
+;
+_ReadTime:
+	CALL	ResetOFF		; turn of RTC reset
+	LD	C,10111111B		; (255 - 64)
+	CALL	RTC_WR			; send COMMAND BYTE (BURST READ) to DS1302
+	CALL	RTC_RD			; C = ?SSSssss
+	LD	A,C
+	AND	7FH			; discard clock halt flag
+	CALL	FromBCD
+	LD	E,A			; E = seconds
+	CALL	RTC_RD			; C = ?MMMmmmm
+	LD	A,C
+	CALL	FromBCD
+	LD	D,A			; D = minutes
+	CALL	RTC_RD			; C = ??HHhhhh
+	LD	A,C
+	AND	3FH			; 24 hours
+	CALL	FromBCD
+	LD	L,A			; L = hours
+	LD	H,0
+	CALL	ResetON			; ends the burst read
+	RET
+;
+;	A = BCD byte, returns A = its value, uses B,C
+;
+FromBCD:
+	LD	B,A
+	AND	0F0H			; A = tens x 16
+	RRCA				; A = tens x 8
+	LD	C,A
+	RRCA
+	RRCA				; A = tens x 2
+	ADD	A,C			; A = tens x 10
+	LD	C,A
+	LD	A,B
+	AND	0FH			; A = units
+	ADD	A,C
+	RET
+;
 Delay:
 	PUSH	AF			; 11 t-states
 	LD	A,7			; 7 t-states ADJUST THE TIME 13h IS FOR 4 MHZ
@@ -5,6 +5,8 @@ long	GetTime(void); 	/* writes HH:MM:SS to the top-right corner of the screen */
 			/* current cursor position on screen NOT affected */
 			/* returns E = seconds, D = minutes, L = hours, H = 0 */
 
+long	ReadTime(void);	/* returns the time as GetTime, nothing written */
+
 void	GetStartTime(void);
 void	GetStopTime(void);
 void	PrintLapseTime(void);	/* writes (StopTime - StartTime) as HH:MM:SS */
@@ -180,6 +180,15 @@ void torve(void);
 void villiers(void);
 void louisa(void);
 void mymove(void);
+void planturn(void);
+void bench(void);
+void bearinit(void);
+void cubeturn(void);
+bool takecube(void);
+void tourney( int games, int mine, int yours );
+
+extern int tactics, nroll, rolllen;
+extern bool quiet;
 
 
 void EXIT(void)
@@ -289,11 +298,19 @@ void	chooseplayer(void) {
 ======================================================================*/
 
 char *p1 = "Play,Reverse,Swap,New,Quit,Load,(CR : more)";
-char *p2 = "Use %s dice,Opponent,Count(CR : go back)";
+char *p2 = "Use %s dice,Opponent,Count,Tactics,Bench,Games(CR : go back)";
 
-void main(void) {
+void main(int argc, char **argv) {
 char ch;
 
+	/* BACKGMMN T games mystyle yrstyle : self-play, no screen I/O */
+	if (argc == 5 && *argv[1] == 'T') {
+		quiet = TRUE;
+		setup();
+		tourney(atoi(argv[2]), atoi(argv[3]), atoi(argv[4]));
+		exit(0);
+	}
+
 	Save_fonts();
 	Load_fonts();
 
@@ -361,6 +378,27 @@ char ch;
 				case 'U':
 					yrdice ^= TRUE;
 					break;
+				case 'T': {  /* rule based or evaluated plays */
+					tactics ^= TRUE;
+					debug(tactics ? "I play by the rules of thumb" 
+						      : "I weigh every play");
+					break;
+					}
+				case 'B': {  /* time the play finder */
+					bench();
+					break;
+					}
+				case 'G': {  /* rollouts for the cube */
+					msg("Cube rollout games (0: by the rules)? ");
+					getchars(buzzard, 3);
+					nroll = atoi(buzzard);
+					if (nroll) {
+						putstr("  Turns each (0: to the end)? ");
+						getchars(buzzard, 3);
+						rolllen = atoi(buzzard);
+					}
+					break;
+					}
 				case 'O': {  /* change opponents and skill level */
 					chooseplayer();
 					deciding = FALSE;
@@ -398,15 +436,7 @@ void cont(void) {
 
 		getmove();
 		player = other(player);
-		if ( player == ME ) {
-			if ( endgame() ) {
-				if (topstone(ME) < 6 && cubeval()) idouble();
-				else if ( mytotal() < (yrtotal() - 8) ) {
-					idouble();
-				}
-			}
-			else if ( bearoff() ) idouble();
-		}
+		if ( player == ME ) cubeturn();
 	}
 } 
 
@@ -483,7 +513,7 @@ char ch;
 		/* handle doubles as two consecutive, independent moves */
 		setchat("I move"); debug(chatter);
 		if (movesleft == 4) myturns = 2; else myturns = 1;
-		clrpend();
+		clrpend(); planturn();
 		while (myturns > 0) {
 			cantuse = ERROR;
 			movesleft = 2;
@@ -521,15 +551,7 @@ void taketurns(void) {
 
 		getmove();
 		player = other(player);
-		if ( player == ME ) {
-			if ( endgame() ) {
-				if (topstone(ME) < 6 && cubeval()) idouble();
-				else if ( mytotal() < (yrtotal() - 8) ) {
-					idouble();
-				}
-			}
-			else if ( bearoff() ) idouble();
-		}
+		if ( player == ME ) cubeturn();
 		rolldice (player); 
 	}
 } 
@@ -902,6 +924,7 @@ void setup(void) {
 int i, j, k;
 
 	xrndseed();
+	bearinit();
 
 	myscore = yrscore = player = dice[0] = dice[1] = 0;
 	yrdice = FALSE;
@@ -1385,7 +1408,7 @@ int ineed, yuneed, yrtop, mytop;
 
 void testcube(void) {
 
-	if (cubeval()) {
+	if (takecube()) {
 		debug("I accept the cube.");
 		notyrcube();
 		doubles.cube *= 2;
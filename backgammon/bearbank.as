@@ -0,0 +1,200 @@
+;
+;	Bear-off database, in the two extra 32K banks of the Z80ALL
+;
+;	Writing 1 or 2 to port 1FH maps a bank at 0000H-7FFFH, 0 maps back
+;	the TPA : this code and its buffer must be stored above 8000H
+;	(psect top, see linkback.sub)
+;
+;	byte n is in bank 1 + n/32K, at n%32K
+;	BEAROFF.DB holds the whole database, 424 records (54272 bytes)
+;
+	global	_BGet, _BPut, _LoadBear, _SaveBear, _BankSafe
+	global	__Hdata		; end of data, set by the linker
+;
+BDOS	equ	5
+BANKPORT equ	1FH
+DBENDH	equ	0D4H		; 424 * 128 = 0D400H
+
+	psect	top
+
+fcb:				; fcb
+	defb	0		; disk+1
+	defm	"BEAROFF DB "   ; file name
+fcbex:	defb	0		; EX=0
+	defb	0,0		; S1,S2
+	defb	0		; RC=0
+	defb	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0	; D0,...D15
+fcbcr:	defb	0		; CR=0
+	defb	0,0,0		; R0,R1,R2
+;
+buf:	defs	128
+ptr:	defs	2		; database offset of buf
+;
+;	Select the bank of the database byte HL, HL = its address there
+;
+bank:
+	ld	a,h
+	rlca
+	and	1
+	inc	a		; bank 1 or 2
+	res	7,h
+	ld	c,BANKPORT
+	out	(c),a
+	ret
+;
+;	Select 0
+;
+bank0:
+	xor	a
+	ld	c,BANKPORT
+	out	(c),a
+	ret
+;
+;unsigned char BGet(unsigned int index)
+;
+_BGet:
+	ld	hl,2
+	add	hl,sp
+	ld	a,(hl)
+	inc	hl
+	ld	h,(hl)
+	ld	l,a		; HL=index
+	call	bank
+	ld	l,(hl)
+	jr	bank0
+;
+;void BPut(unsigned int index, unsigned char value)
+;
+_BPut:
+	ld	hl,4
+	add	hl,sp
+	ld	e,(hl)		; E=value
+	dec	hl
+	ld	a,(hl)
+	dec	hl
+	ld	l,(hl)
+	ld	h,a		; HL=index
+	call	bank
+	ld	(hl),e
+	jr	bank0
+;
+;	Prepare fcb, set DMA to buf and the offset to 0
+;
+prepare:
+	xor	a
+	ld	(fcbex),a
+	ld	(fcbcr),a
+	ld	hl,0
+	ld	(ptr),hl
+	ld	de,buf
+	ld	c,26
+	jp	BDOS
+;
+;	Copy 128 bytes from (HL) to (DE), in the bank of (ptr), next ptr
+;
+copy:
+	push	hl
+	push	de
+	ld	hl,(ptr)
+	call	bank		; HL=address in the bank
+	pop	de
+	ex	(sp),hl		; (SP)=bank address, HL=source
+	pop	bc		; BC=bank address
+	ld	a,d
+	or	e
+	jr	nz,1f
+	ld	d,b		; DE=0 : to the bank
+	ld	e,c
+	jr	2f
+1:	ld	h,b		; HL=0 : from the bank
+	ld	l,c
+2:	ld	bc,128
+	ldir
+	call	bank0
+	ld	hl,(ptr)
+	ld	de,128
+	add	hl,de
+	ld	(ptr),hl
+	ret
+;
+;char BankSafe(void)
+;	returns 1 if text and data end below 8000H (out of the banks way),
+;	0 if the program was linked too big for them
+;
+_BankSafe:
+	ld	hl,__Hdata
+	ld	de,8001H
+	or	a
+	sbc	hl,de
+	ld	l,0
+	ret	nc		; __Hdata > 8000H
+	inc	l
+	ret
+;
+;char LoadBear(void)
+;	returns 1 if BEAROFF.DB was loaded, 0 if not found or short
+;
+_LoadBear:
+	call	prepare
+	ld	de,fcb		; open file
+	ld	c,15
+	call	BDOS
+	inc	a
+	jr	nz,1f
+	ld	l,a		; not found
+	ret
+1:
+	ld	de,fcb		; read record
+	ld	c,20
+	call	BDOS
+	or	a
+	jr	nz,fail
+	ld	hl,buf		; buf to the bank
+	ld	de,0
+	call	copy
+	ld	a,h
+	cp	DBENDH
+	jr	nz,1b
+	ld	l,1
+	jr	close
+fail:
+	ld	l,0
+close:
+	push	hl
+	ld	de,fcb		; close file
+	ld	c,16
+	call	BDOS
+	pop	hl
+	ret
+;
+;char SaveBear(void)
+;	returns 1 if BEAROFF.DB was written, else 0
+;
+_SaveBear:
+	call	prepare
+	ld	de,fcb		; delete old file
+	ld	c,19
+	call	BDOS
+	ld	de,fcb		; make file
+	ld	c,22
+	call	BDOS
+	inc	a
+	jr	nz,1f
+	ld	l,a		; disk directory full
+	ret
+1:
+	ld	hl,0		; the bank to buf
+	ld	de,buf
+	call	copy
+	ld	de,fcb		; write record
+	ld	c,21
+	call	BDOS
+	or	a
+	jr	nz,fail
+	ld	hl,(ptr)
+	ld	a,h
+	cp	DBENDH
+	jr	nz,1b
+	ld	l,1
+	jr	close
+;
@@ -6,6 +6,10 @@
 /*               strategy for making the computer's move in Gammon IV */
 /*--------------------------------------------------------------------*/
 
+#include <stdio.h>
+#include <string.h>
+#include <conio.h>
+
 #define TRUE 1
 #define FALSE 0
 #define ME 1
@@ -40,6 +44,15 @@ extern int level, dice[2], myscore, yrscore, player, movesleft, cantuse,
 
 extern char *chatter[80];
 
+struct mv { char fr, to, hit, die; };  /* one stone moved by one die */
+
+long ReadTime(void);
+unsigned char BGet( unsigned int index );
+void BPut( unsigned int index, unsigned char value );
+bool BankSafe(void);
+bool LoadBear(void);
+bool SaveBear(void);
+
 int (*fp4)( int f1, int t1, int f2, int t2 );
 int (*fp2)( int a, int b );
 
@@ -160,6 +173,31 @@ void torve(void);
 void villiers(void);
 void louisa(void);
 void mymove(void);
+void makekeys(void);
+void loadboard(void);
+int target( int from, int d );
+void makemv( struct mv *m );
+void unmakemv( struct mv *m );
+bool fresh(void);
+int evaluate(void);
+void leaf( int n );
+void gen( int n );
+int findplay( int d0, int d1 );
+void planturn(void);
+long seconds(void);
+void bench(void);
+unsigned int bearindex(void);
+void bearfill( int pt, int rem );
+void bearinit(void);
+void flip(void);
+int gamevalue(void);
+int raceguess( int who );
+int playout( int who, int d0, int d1, int turns );
+int rollout( int who );
+void startboard(void);
+void tourney( int games, int mine, int yours );
+void cubeturn(void);
+bool takecube(void);
 
 /*=============================================*/
 /*     M Y   M O V E                           */
@@ -883,9 +921,601 @@ void louisa(void) {
 	}
 }
 
+/*=============================================*/
+/*     P L A Y   F I N D E R                   */
+/*=============================================*/
+
+/*--------------------------------------------------------------------*/
+/* Every legal play for a roll is generated on a private copy of the  */
+/* board, each position reached is scored once (a small hash set      */
+/* drops the duplicates: 3-1 and 1-3 often end on the same board) and */
+/* the best scoring play is kept, to be made one stone at a time by   */
+/* mymove().  The rule based tactics above can still be selected.     */
+/*--------------------------------------------------------------------*/
+
+#define EVAL 0
+#define RULES 1
+#define MAXDICE 4
+#define HASHSIZE 256	/* power of 2 */
+#define BENCHEVALS 1000
+#define BEARPOS 54264	/* positions of 15 stones or less on 6 points */
+
+int tactics = EVAL;
+bool bearok = FALSE, bearing = FALSE;
+bool quiet = FALSE;	/* self-play: nothing written, no key read */
+
+unsigned char my[28], yr[28];	/* my stones, your stones, as point[] */
+unsigned int zmy[28], zyr[28], lmy[28], lyr[28], hash, lock;
+bool keys = FALSE;
+
+struct { unsigned int hash, lock; unsigned char stamp; } seen[HASHSIZE];
+unsigned char stamp;  /* slots of an older stamp are empty */
+
+struct mv seq[MAXDICE], plan[MAXDICE];
+int die[MAXDICE], ndice, bestrank, bestscore, nplan, planstep;
+unsigned int evals;
+
+/* evaluation weights, one playing style for each level */
+struct style { int pip, blot, shot, point, home, prime, hit, off; } 
+	styles[3] = {
+		{ 1, 6, 3, 4, 6, 2, 4, 8 },	/* villiers: safe play */
+		{ 1, 4, 2, 4, 7, 3, 6, 8 },	/* louisa: balanced */
+		{ 1, 3, 1, 5, 8, 4, 8, 8 }	/* torve: hits and primes */
+	};
+
+int primeval[] = { 0, 0, 1, 3, 6, 10, 16 };
+
+
+void makekeys(void) {  /* random keys of the position hash */
+int i;
+	for (i = 0; i < 28; i++) {
+		zmy[i] = (xrnd() << 1) ^ xrnd();
+		zyr[i] = (xrnd() << 1) ^ xrnd();
+		lmy[i] = (xrnd() << 1) ^ xrnd();
+		lyr[i] = (xrnd() << 1) ^ xrnd();
+	}
+	keys = TRUE;
+}
+
+
+void loadboard(void) {  /* copy point[] and hash it */
+int i;
+	if (!keys) makekeys();
+	hash = lock = 0;
+	for (i = 0; i < 28; i++) {
+		my[i] = (point[i].owner == ME) ? point[i].stones : 0;
+		yr[i] = (point[i].owner == YU) ? point[i].stones : 0;
+		hash += my[i] * zmy[i] + yr[i] * zyr[i];
+		lock += my[i] * lmy[i] + yr[i] * lyr[i];
+	}
+}
+
+
+int target( int from, int d ) {  /* where my stone lands, 0 if it can't */
+int to, i;
+	if (my[from] == 0) return (0);
+	if (my[MYBAR] && from != MYBAR) return (0);  /* bar first! */
+	to = from - d;
+	if (to > 0) return (yr[to] > 1 ? 0 : to);
+
+	/* bearing off: all stones home, and exact or from the highest */
+	for (i = MYBAR; i > 6; i--) if (my[i]) return (0);
+	if (to < 0) for (i = from + 1; i < 7; i++) if (my[i]) return (0);
+	return (MYHOME);
+}
+
+
+void makemv( struct mv *m ) {  /* the hash follows the board */
+	my[m->fr]--; my[m->to]++;
+	hash += zmy[m->to] - zmy[m->fr];
+	lock += lmy[m->to] - lmy[m->fr];
+	if (m->hit) {
+		yr[m->to] = 0; yr[YRBAR]++;
+		hash += zyr[YRBAR] - zyr[m->to];
+		lock += lyr[YRBAR] - lyr[m->to];
+	}
+}
+
+
+void unmakemv( struct mv *m ) {
+	if (m->hit) {
+		yr[m->to] = 1; yr[YRBAR]--;
+		hash -= zyr[YRBAR] - zyr[m->to];
+		lock -= lyr[YRBAR] - lyr[m->to];
+	}
+	my[m->fr]++; my[m->to]--;
+	hash -= zmy[m->to] - zmy[m->fr];
+	lock -= lmy[m->to] - lmy[m->fr];
+}
+
+
+bool fresh(void) {  /* first time this position is reached? */
+int i, n;
+	i = hash & (HASHSIZE - 1);
+	for (n = 0; n < HASHSIZE; n++) {
+		if (seen[i].stamp != stamp) {
+			seen[i].hash = hash; seen[i].lock = lock;
+			seen[i].stamp = stamp;
+			return (TRUE);
+		}
+		if (seen[i].hash == hash && seen[i].lock == lock) return (FALSE);
+		i = (i + 1) & (HASHSIZE - 1);
+	}
+	return (TRUE);  /* full, just score it again */
+}
+
+
+int evaluate(void) {  /* static score of my[], yr[] for me */
+int i, j, score, mypip, yrpip, mytop, yrlow, run, longest, shots;
+struct style *w;
+
+	if (bearing) return (-BGet(bearindex()));  /* building the database */
+
+	w = &styles[level];
+	score = run = longest = 0;
+	mypip = my[MYBAR] * 25;
+	yrpip = yr[YRBAR] * 25;
+	mytop = my[MYBAR] ? MYBAR : 0;   /* my last stone */
+	yrlow = yr[YRBAR] ? YRBAR : 25;  /* your last stone */
+
+	for (i = 1; i < 25; i++) {
+		if (my[i]) {
+			mypip += my[i] * i;
+			if (mytop < i) mytop = i;
+		}
+		if (yr[i]) {
+			yrpip += yr[i] * (25 - i);
+			if (yrlow > i) yrlow = i;
+		}
+		if (my[i] > 1) {  /* a made point, better in my inner table */
+			score += (i < 8) ? w->home : w->point;
+			if (++run > longest) longest = run;
+		}
+		else run = 0;
+	}
+
+	/* no more contact, it's a race: only pips and stones off count, */
+	/* or when all my stones are home, the rolls I need to bear off  */
+	/* (1/16 roll, about half a pip)                                 */
+	if (mytop < yrlow) {
+		if (bearok && mytop < 7)
+			return ((yrpip - (BGet(bearindex()) >> 1)) * w->pip);
+		return ((yrpip - mypip) * w->pip + my[MYHOME] * w->off);
+	}
+
+	/* blots you can still reach, worse within a direct shot */
+	for (i = yrlow + 1; i < 25; i++) {
+		if (my[i] != 1) continue;
+		shots = 0;
+		for (j = (i > 6 ? i - 6 : 0); j < i; j++) if (yr[j]) shots++;
+		score -= w->blot + shots * w->shot;
+	}
+
+	if (longest > 6) longest = 6;
+	score += (yrpip - mypip) * w->pip + primeval[longest] * w->prime;
+	score += yr[YRBAR] * w->hit + my[MYHOME] * w->off;
+	return (score);
+}
+
+
+void leaf( int n ) {  /* a complete play of n dice */
+int rank, score, i;
+
+	/* use as many dice as I can, the high die if only one */
+	rank = n * 8;
+	if (n == 1) rank += seq[0].die;
+	if (rank < bestrank) return;
+	if (rank > bestrank) {
+		bestrank = rank;
+		bestscore = -32767;
+		if (++stamp == 0) {  /* empty the set */
+			memset(seen, 0, sizeof(seen));
+			stamp = 1;
+		}
+	}
+	if (!fresh()) return;
+
+	evals++;
+	score = evaluate();
+	if (score > bestscore) {
+		bestscore = score;
+		nplan = n;
+		for (i = 0; i < n; i++) plan[i] = seq[i];
+	}
+}
+
+
+void gen( int n ) {  /* try every stone with die n, then go deeper */
+int from, to;
+bool moved;
+struct mv *m;
+
+	moved = FALSE;
+	if (n < ndice) {
+		m = &seq[n];
+		for (from = MYBAR; from > 0; from--) {
+			if ((to = target(from, die[n])) == 0) continue;
+			m->fr = from; m->to = to; m->die = die[n];
+			m->hit = (to != MYHOME && yr[to] == 1);
+			makemv(m);
+			gen(n + 1);
+			unmakemv(m);
+			moved = TRUE;
+		}
+	}
+	if (!moved) leaf(n);
+}
+
+
+int findplay( int d0, int d1 ) {  /* best play for the board in my[], yr[] */
+	bestrank = -1;
+	nplan = planstep = 0;
+	if (d0 == d1) {
+		ndice = 4;
+		die[0] = die[1] = die[2] = die[3] = d0;
+		gen(0);
+	}
+	else {  /* both orders */
+		ndice = 2;
+		die[0] = d0; die[1] = d1; gen(0);
+		die[0] = d1; die[1] = d0; gen(0);
+	}
+	return (nplan);
+}
+
+
+void planturn(void) {  /* called as my turn starts */
+	if (tactics != EVAL) return;
+	loadboard();
+	findplay(dice[0], dice[1]);
+}
+
+
+long seconds(void) {  /* time of day, from the RTC (not drawn) */
+long t;
+	t = ReadTime();
+	return ((t >> 16) & 0xFF) * 3600L + ((t >> 8) & 0xFF) * 60L + (t & 0xFF);
+}
+
+
+void bench(void) {  /* evaluation speed, on the board as it is */
+long t, u;
+int i, j;
+
+	loadboard();
+	t = seconds();
+	for (i = 0; i < BENCHEVALS; i++) evaluate();
+	t = seconds() - t;
+	if (t < 0) t += 86400L;  /* past midnight */
+
+	evals = 0;
+	u = seconds();
+	for (i = 1; i < 7; i++)
+		for (j = i; j < 7; j++) findplay(i, j);
+	u = seconds() - u;
+	if (u < 0) u += 86400L;
+
+	debug("");
+	printf("%d evals: %ld s, all 21 rolls: %u plays in %ld s",
+		BENCHEVALS, t, evals, u);
+}
+
+
+/*---------------------------------------------------------------------*/
+/* BEAR-OFF DATABASE: the expected number of rolls I need to bear off, */
+/* in 1/16 roll, for each position of my inner table (one byte each,   */
+/* 53K, in the Z80ALL banks).  The positions are ranked in the order   */
+/* of (stones on 6, on 5, ... on 1): any move from a position leads to */
+/* a lower rank, so they are built in that order, each from the best   */
+/* plays of the 21 rolls, looking up the positions already built.      */
+/* Built once, into BEAROFF.DB, then just loaded.                      */
+/*---------------------------------------------------------------------*/
+
+unsigned int comb[7][16];  /* positions of n stones or less on k points */
+unsigned int bearpos;
+
+
+unsigned int bearindex(void) {  /* rank of my inner table */
+int i, c, rem;
+unsigned int index;
+	index = 0; rem = 15;
+	for (i = 6; i > 0; i--) {
+		c = my[i];
+		index += comb[i][rem] - comb[i][rem - c];
+		rem -= c;
+	}
+	return (index);
+}
+
+
+void bearfill( int pt, int rem ) {  /* every position, in rank order */
+int c, d0, d1;
+unsigned int sum;
+
+	if (pt) {
+		for (c = 0; c <= rem && bearing; c++) {
+			my[pt] = c;
+			bearfill( pt - 1, rem - c );
+		}
+		my[pt] = 0;
+		return;
+	}
+
+	sum = 0;
+	if (bearpos) {  /* 0 is all stones off */
+		for (d0 = 1; d0 < 7; d0++)
+			for (d1 = d0; d1 < 7; d1++) {
+				hash = lock = 0;
+				findplay(d0, d1);
+				sum -= (d0 == d1 ? 1 : 2) * bestscore;
+			}
+		sum = 16 + (sum + 18) / 36;
+		if (sum > 255) sum = 255;
+	}
+	BPut(bearpos++, sum);
+
+	if ((bearpos & 1023) == 0 && !quiet) {
+		printf("\r%5u/%u", bearpos, BEARPOS);
+		if (kbhit()) {
+			getch();
+			bearing = FALSE;  /* skipped */
+		}
+	}
+}
+
+
+void bearinit(void) {  /* load the database, or build it */
+int k, n;
+
+	for (k = 0; k < 7; k++)
+		for (n = 0; n < 16; n++)
+			comb[k][n] = (k && n) ? comb[k - 1][n] + comb[k][n - 1] : 1;
+
+	if ( !BankSafe() ) {	/* text+data would be overlaid by the banks */
+		if (!quiet) printf("Linked above 8000H, no bear-off database (see linkback.sub)\r\n");
+		return;
+	}
+
+	if ( LoadBear() ) {
+		bearok = TRUE;
+		return;
+	}
+
+	if (!quiet) printf("Building the bear-off database, once (any key to skip)\r\n");
+	if (!keys) makekeys();
+	memset(my, 0, sizeof(my));
+	memset(yr, 0, sizeof(yr));
+	bearpos = 0;
+	bearing = TRUE;
+	bearfill( 6, 15 );
+	if ( bearing ) {
+		bearing = FALSE;
+		bearok = TRUE;
+		if ( !SaveBear() && !quiet ) printf("\r\nCould not write BEAROFF.DB!");
+	}
+}
+
+
+/*---------------------------------------------------------------------*/
+/* ROLLOUTS: the cube is decided by playing nroll quick games from the */
+/* position, on my[] and yr[] only (nothing is drawn), both sides      */
+/* using the play finder (your side is played on the flipped board).   */
+/* After rolllen turns (0 = play to the end) a game is scored from     */
+/* the pip counts.  The equity is in 1/100 point, for me, cubeless.    */
+/*---------------------------------------------------------------------*/
+
+#define DOUBLEEQ 40	/* I double from here on */
+#define TOOGOOD 100	/* ... up to here, then I play for the gammon */
+#define TAKEEQ -50	/* I take from here on */
+
+int nroll = 24, rolllen = 12;
+int rwins, rgammons;  /* games I won, of them gammons, last rollout */
+int mystyle, yrstyle;  /* the level each side plays */
+
+
+void flip(void) {  /* see the board from the other side */
+int i, t;
+	for (i = 0; i < 26; i++) {
+		t = my[i]; my[i] = yr[25 - i]; yr[25 - i] = t;
+	}
+	t = my[MYHOME]; my[MYHOME] = yr[YRHOME]; yr[YRHOME] = t;
+}
+
+
+int gamevalue(void) {  /* 0 if I did not win yet */
+int i;
+	if (my[MYHOME] < 15) return (0);
+	if (yr[YRHOME]) return (100);
+	for (i = YRBAR; i < 7; i++) if (yr[i]) return (300);
+	return (200);
+}
+
+
+int raceguess( int who ) {  /* rolllen reached: judge the pip counts */
+int i, mypip, yrpip, e;
+	mypip = yrpip = 0;
+	for (i = 0; i < 26; i++) {
+		mypip += my[i] * i;
+		yrpip += yr[i] * (25 - i);
+	}
+	e = yrpip - mypip + (who == ME ? 4 : -4);  /* a roll is about 8 */
+	e = (int)((long)e * 800 / (mypip + yrpip + 1));
+	if (e > 100) e = 100;
+	if (e < -100) e = -100;
+	return (e);
+}
+
+
+int playout( int who, int d0, int d1, int turns ) {
+/* play my[], yr[] on, who first with d0-d1 (0: rolled), for turns */
+/* (0: to the end); returns what I win, < 0 if I lose              */
+int turn, side, keep, n, i, e;
+
+	keep = level;
+	side = who;
+	for (turn = 0; ; turn++) {
+		if (turns && turn == turns) {
+			e = raceguess(side);
+			break;
+		}
+		if (!d0) {
+			d0 = (xrnd() % 6) + 1;
+			d1 = (xrnd() % 6) + 1;
+		}
+		if (side == YU) {
+			flip();
+			level = yrstyle;
+		}
+		else level = mystyle;
+		n = findplay( d0, d1 );
+		for (i = 0; i < n; i++) makemv( &plan[i] );
+		e = gamevalue();
+		if (side == YU) {
+			flip();
+			e = -e;
+		}
+		if (e) break;
+		side = (side == ME) ? YU : ME;
+		d0 = 0;
+	}
+	level = keep;
+	return (e);
+}
+
+
+int rollout( int who ) {  /* my equity, who is on roll */
+unsigned char my0[28], yr0[28];
+int g, e;
+long total;
+
+	loadboard();
+	memcpy(my0, my, sizeof(my));
+	memcpy(yr0, yr, sizeof(yr));
+	total = 0; rwins = rgammons = 0;
+	mystyle = yrstyle = level;
+
+	for (g = 0; g < nroll; g++) {
+		memcpy(my, my0, sizeof(my));
+		memcpy(yr, yr0, sizeof(yr));
+		e = playout( who, 0, 0, rolllen );
+		if (e > 0) rwins++;
+		if (e > 100) rgammons++;
+		total += e;
+	}
+	return ((int)(total / nroll));
+}
+
+
+/*---------------------------------------------------------------------*/
+/* SELF-PLAY: BACKGMMN T games mystyle yrstyle plays that many games   */
+/* between two levels, with nothing on the screen, and appends the     */
+/* score and the games per minute to BGSTATS.TXT                       */
+/*---------------------------------------------------------------------*/
+
+char *stylename[] = { "villiers", "louisa", "torve" };
+
+
+void startboard(void) {  /* my[], yr[] as newboard() */
+	memset(my, 0, sizeof(my));
+	memset(yr, 0, sizeof(yr));
+	my[24] = 2; my[13] = 5; my[8] = 3; my[6] = 5;
+	yr[1] = 2; yr[12] = 5; yr[17] = 3; yr[19] = 5;
+}
+
+
+void tourney( int games, int mine, int yours ) {
+int g, e, d0, d1, won[2][3];  /* me, you: singles, gammons, backgammons */
+long t;
+FILE *f;
+
+	if (mine < 0 || mine > 2) mine = 0;
+	if (yours < 0 || yours > 2) yours = 0;
+	mystyle = mine; yrstyle = yours;
+	memset(won, 0, sizeof(won));
+	if (!keys) makekeys();
+
+	t = seconds();
+	for (g = 0; g < games; g++) {
+		startboard();
+		do {  /* the opening roll: one die each */
+			d0 = (xrnd() % 6) + 1;
+			d1 = (xrnd() % 6) + 1;
+		} while (d0 == d1);
+		e = playout( (d0 > d1) ? ME : YU, d0, d1, 0 );
+		if (e > 0) won[0][e / 100 - 1]++;
+		else won[1][-e / 100 - 1]++;
+	}
+	t = seconds() - t;
+	if (t < 0) t += 86400L;  /* past midnight */
+	if (t == 0) t = 1;
+
+	if ((f = fopen("BGSTATS.TXT", "a")) == NULL) return;
+	fprintf(f, "%d games, %s against %s, %ld s, %ld.%ld games/min\r\n",
+		games, stylename[mine], stylename[yours], t,
+		games * 60L / t, (games * 600L / t) % 10);
+	fprintf(f, "  %-8s wins %d, gammons %d, backgammons %d\r\n",
+		stylename[mine], won[0][0] + won[0][1] + won[0][2], 
+		won[0][1], won[0][2]);
+	fprintf(f, "  %-8s wins %d, gammons %d, backgammons %d\r\n",
+		stylename[yours], won[1][0] + won[1][1] + won[1][2], 
+		won[1][1], won[1][2]);
+	fclose(f);
+}
+
+
+void cubeturn(void) {  /* shall I double, before my roll? */
+int e;
+
+	if (doubles.whosecube == YU || doubles.cube > 256) return;
+
+	/* as the old rules, no double before the race or the bear-off */
+	if ( !endgame() && !bearoff() ) return;
+
+	if (nroll) {
+		/* behind in the race (the roll is worth 4 pips): no double */
+		if ( !bearoff() && mytotal() - 4 > yrtotal() ) return;
+		debug("Rolling out the cube...");
+		e = rollout(ME);
+		debug("");
+		if (e >= DOUBLEEQ && e < TOOGOOD) idouble();
+		return;
+	}
+
+	if ( endgame() ) {
+		if (topstone(ME) < 6 && cubeval()) idouble();
+		else if ( mytotal() < (yrtotal() - 8) ) {
+			idouble();
+		}
+	}
+	else if ( bearoff() ) idouble();
+}
+
+
+bool takecube(void) {  /* you doubled, before your roll */
+	if (nroll) {
+		debug("Rolling out the cube...");
+		return (rollout(YU) >= TAKEEQ);
+	}
+	return ( cubeval() );
+}
+
 
 void mymove(void) {
 int d;
+struct mv *m;
+
+	if ( tactics == EVAL ) {
+		if ( book() ) return;
+		if ( planstep < nplan ) {
+			m = &plan[planstep++];
+			lurch( m->fr, m->to, (m->die == dice[0]) ? 0 : 1 );
+		}
+		else {
+			strcat(chatter," and now I'm blocked ");
+			myturns = movesleft = 0;
+		}
+		return;
+	}
 
 	if ( nomove() ) {
 		if (lookforit && (dice[0] != dice[1])) {
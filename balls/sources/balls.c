@@ -3,11 +3,12 @@
 //	only for Z80ALL
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define XMAX 123
 #define YMAX 113
 #define int_part(x) (x >> 8)
-#define ONE_STEP 1
 
 #define REV_BLANK	0x20+0x80
 
@@ -18,7 +19,7 @@ int halfPI = 0x192;     //fp    PI/2
 int PI = 0x324;         //fp    PI
 int twoPI = 0x648;      //fp    2*PI
 int threePI = 0x96C;    //fp    3*PI
-int delta;              //fp    movement increment
+int xstep, ystep;       //fp    one step along angle
 int angle;
 
 void CrtSetup(void);
@@ -26,55 +27,151 @@ void CrtOut(char);
 char CrtIn(void);
 char CrtSts(void);
 void putstr(char*);
+char GetSeconds(void);
 
 void	PrintChar(int Y, int X, char ch);
 
-int VirtualToRealRow(int vRow)
-{
-	int n = vRow/5;
-	int v = vRow % 5;
-
-	if (v == 0 || v == 1)
-		return 1 + 2*n;
-	else if (v == 2 || v == 3)
-		return 2 + 2*n;
-	else
-		return 3 + 2*n;
-}
+// virtual row (0...119) to screen row, and to the font index row part
+// ((row % 5) * 2), built once by InitRows: show() and hide() are then
+// a few table reads and a PrintChar, no division
+#define VROWS 120
+
+unsigned char RealRow[VROWS];
+unsigned char RowPhase[VROWS];
+unsigned char FontIndex[10] = { 1, 3, 2, 4, 5, 8, 6, 10, 7, 9 };
 
-int GetFontIndex(int vRow, int vCol)
+#define VirtualToRealRow(vRow)		RealRow[vRow]
+#define GetFontIndex(vRow, vCol)	FontIndex[RowPhase[vRow] + ((vCol) & 1)]
+
+void InitRows(void)
 {
-	int v = vRow % 5;
-	int x = vCol % 2;
-
-	if (v == 0)
-		return x == 0 ? 1 : 3;
-	else if (v == 1)
-		return x == 0 ? 2 : 4;
-	else if (v == 2)
-		return x == 0 ? 5 : 8;
-	else if (v == 3)
-		return x == 0 ? 6 : 10;
-	else
-		return x == 0 ? 7 : 9;
+	unsigned char v, n, p;
+
+	for (v = 0, n = 0, p = 0; v < VROWS; v++)
+	{
+		RealRow[v] = 1 + 2*n + (p >> 2);	// v % 5 = 0,1 / 2,3 / 4
+		RowPhase[v] = p;
+
+		if ((p += 2) == 10)
+		{
+			p = 0;
+			n++;
+		}
+	}
 }
 
 void show(int x, int y)
 {
-	PrintChar(VirtualToRealRow(y), 1 + (x/2), 0x40 + GetFontIndex(y, x));
+	PrintChar(VirtualToRealRow(y), 1 + (x >> 1), 0x40 + GetFontIndex(y, x));
 }
 
 void hide(int x, int y)
 {
-	PrintChar(VirtualToRealRow(y), 1 + (x/2), ' ');
+	PrintChar(VirtualToRealRow(y), 1 + (x >> 1), ' ');
 }
 
-void short_wait(void)
+// pacing: the ball makes TPS steps per second, shown in FPS frames,
+// whatever the CPU clock. The DS1302 only counts seconds, so the frames
+// of each second are counted and the idle time of a frame is tuned
+// from the idle loops one second holds (measured at start)
+
+#define FPS	50		// frames per second
+#define TPS	100		// steps per second
+#define SECONDS	10		// time to catch the ball
+
+long spins;			// idle loops per second
+int idle;			// idle loops per frame
+int fps;			// frames shown in the last second
+int frames;			// frames shown in this second
+int tickacc;			// steps due, in 1/fps units
+int due;			// steps left in this frame
+char second;			// current RTC second (BCD)
+char synced;			// a whole second was counted
+
+// counts the idle loops in one second, between two RTC second changes
+void CalibrateFrames(void)
 {
 	int i;
+	char s;
+
+	spins = 0;
+	s = GetSeconds();
 
-	for (i=0; i<1000; i++)
+	while (GetSeconds() == s)
 		;
+
+	s = GetSeconds();
+
+	do
+	{
+		for (i = 0; i < 100; i++)
+			CrtSts();
+
+		spins += 100;
+	}
+	while (GetSeconds() == s);
+
+	idle = spins / FPS;
+}
+
+void StartFrames(void)
+{
+	fps = FPS;
+	frames = tickacc = due = 0;
+	second = GetSeconds();
+	synced = 0;
+}
+
+// ends a frame: the idle time polls the keyboard (a key hit ends it),
+// then at each new second the idle time is retuned
+void EndFrame(void)
+{
+	int i;
+	char s;
+
+	for (i = 0; i < idle; i++)
+		if (CrtSts())
+			break;
+
+	frames++;
+	s = GetSeconds();
+
+	if (s == second)
+		return;
+
+	second = s;
+
+	if (synced)
+	{
+		fps = frames;
+		idle += spins / FPS - spins / fps;
+
+		if (idle < 0)
+			idle = 0;
+	}
+
+	synced = 1;
+	frames = 0;
+}
+
+// called before each step: when the steps of this frame are done,
+// waits for the end of the frame and counts the steps due in the next one
+void Pace(void)
+{
+	while (due == 0)
+	{
+		EndFrame();
+
+		tickacc += TPS;
+
+		while (tickacc >= fps)
+		{
+			tickacc -= fps;
+			due++;
+		}
+	}
+
+	due--;
 }
 
 void xrndseed(void);
@@ -84,15 +181,14 @@ void	Clear(void);
 int sin(int);
 int cos(int);
 
-int mult(int count, int fpval)
+// starts a straight segment from (x0,y0) at angle:
+// the step vector is computed once, then added at each move
+void segment(void)
 {
-        int ret=0;
-
-        do
-		ret += fpval;
-        while (--count);
-
-        return ret;
+        xstep = cos(angle);
+        ystep = sin(angle);
+        x = x0;
+        y = y0;
 }
 
 void show_boundaries(void)
@@ -139,7 +235,155 @@ int safe_y(int y)
 char keyhit();
 char getkey();
 
-void    main(void)
+//
+// Stress mode (balls N): N balls bounce inside the boundaries, all of
+// them moving one step per frame, as fast as possible. Each frame the
+// cells left and the cells reached are queued, then written once, and
+// only if they changed. The frames and the characters written in the
+// last second are shown on the top line: a benchmark of the screen writes
+//
+#define MAXBALLS 32
+#define COLS	62		// play area: cols 1...62
+#define AREA	(46 * COLS)	// rows 1...46
+#define CELL(row, col)	(((row) - 1) * COLS + (col) - 1)
+
+struct sball
+{
+	int x, y;		// fp
+	int xstep, ystep;	// fp
+	unsigned char row, col;	// where it is shown
+	unsigned char glyph;
+};
+
+struct sball sballs[MAXBALLS];
+
+unsigned char onscreen[AREA];	// char shown in each cell
+unsigned char queued[AREA];	// 1 = already written this frame
+unsigned char qrow[2 * MAXBALLS], qcol[2 * MAXBALLS], qglyph[2 * MAXBALLS];
+int nq;				// cells queued
+unsigned int writes;		// chars written in this second
+
+void Queue(unsigned char row, unsigned char col, unsigned char glyph)
+{
+	qrow[nq] = row;
+	qcol[nq] = col;
+	qglyph[nq++] = glyph;
+}
+
+// writes the queued cells, the last write of a cell wins
+// and is done only if the cell changes
+void Flush(void)
+{
+	int i;
+	unsigned int c;
+
+	for (i = nq - 1; i >= 0; i--)
+	{
+		c = CELL(qrow[i], qcol[i]);
+
+		if (queued[c])
+			continue;
+
+		queued[c] = 1;
+
+		if (onscreen[c] != qglyph[i])
+		{
+			onscreen[c] = qglyph[i];
+			PrintChar(qrow[i], qcol[i], qglyph[i]);
+			writes++;
+		}
+	}
+
+	for (i = 0; i < nq; i++)
+		queued[CELL(qrow[i], qcol[i])] = 0;
+
+	nq = 0;
+}
+
+// shows a text in the top line, reversed
+void TopLine(int col, char* s)
+{
+	while (*s)
+		PrintChar(47, col++, *s++ | 0x80);
+}
+
+void Stress(int n)
+{
+	struct sball *b;
+	int i, frames = 0, X, Y;
+	unsigned char row, col;
+	char s, sec;
+	char buf[32];
+
+	show_boundaries();
+	PrintChar(24, 32, ' ');		//no basket
+	memset(onscreen, ' ', AREA);
+
+	for (i = 0, b = sballs; i < n; i++, b++)
+	{
+		b->x = (1 + xrnd() % (XMAX - 1)) << 8;
+		b->y = (1 + xrnd() % (YMAX - 1)) << 8;
+		angle = xrnd() % twoPI;
+		b->xstep = cos(angle);
+		b->ystep = sin(angle);
+		b->row = b->col = 1;
+		b->glyph = ' ';
+	}
+
+	sprintf(buf, " %d ball%s, any key to stop ", n, n > 1 ? "s" : "");
+	TopLine(2, buf);
+
+	sec = GetSeconds();
+
+	while (!CrtSts())
+	{
+		// the cells left first, then all the cells reached
+		for (i = 0, b = sballs; i < n; i++, b++)
+		{
+			b->x += b->xstep;
+			b->y += b->ystep;
+
+			X = int_part(b->x);
+			Y = int_part(b->y);
+
+			if ((X >= XMAX && b->xstep > 0) || (X <= 0 && b->xstep < 0))
+				b->xstep = -b->xstep;
+
+			if ((Y >= YMAX && b->ystep > 0) || (Y <= 0 && b->ystep < 0))
+				b->ystep = -b->ystep;
+
+			row = VirtualToRealRow(Y);
+			col = 1 + (X >> 1);
+
+			if (row != b->row || col != b->col)
+			{
+				Queue(b->row, b->col, ' ');
+				b->row = row;
+				b->col = col;
+			}
+
+			b->glyph = 0x40 + GetFontIndex(Y, X);
+		}
+
+		for (i = 0, b = sballs; i < n; i++, b++)
+			Queue(b->row, b->col, b->glyph);
+
+		Flush();
+		frames++;
+
+		if ((s = GetSeconds()) != sec)
+		{
+			sec = s;
+			sprintf(buf, " %3d fps, %5u chars/s ", frames, writes);
+			TopLine(36, buf);
+			frames = writes = 0;
+		}
+	}
+
+	CrtIn();
+}
+
+void    main(int argc, char** argv)
 {
 	int count1 = 0;
 	int count2;
@@ -149,6 +393,27 @@ void    main(void)
 
 	CrtSetup();
 
+	if (argc > 1)
+	{
+		count1 = atoi(argv[1]);
+
+		if (count1 < 1)
+			count1 = 1;
+		else if (count1 > MAXBALLS)
+			count1 = MAXBALLS;
+
+		Save_0_to_10();
+		Load_0_to_10();
+		InitRows();
+		xrndseed();
+
+		Stress(count1);
+
+		Clear();
+		Restore_0_to_10();
+		exit(0);
+	}
+
 	putstr("catch the ball game\r\n\n");
 	putstr("the ball starts from the bottom-left corner,\r\n");
 	putstr(" being thrown in random directions,\r\n");
@@ -160,10 +425,13 @@ void    main(void)
 	putstr(" at your disposal...\r\n\ngood luck!\r\n\npress any key to start\r\n\n");
 	putstr("...and quit anytime with CTRL.C");
 
+	CalibrateFrames();
+
 	CrtIn();
 
 	Save_0_to_10();
 	Load_0_to_10();
+	InitRows();
 
         xrndseed();
 
@@ -187,11 +455,13 @@ void    main(void)
                 // compute random angle (< PI/2)
                 angle = xrnd() % halfPI;
 
-                delta = ONE_STEP;
+                segment();
+
+                StartFrames();
 
                 do
                 {
-                        short_wait();            //wait a little for each step, then...
+                        Pace();                  //wait for the step time, then...
 
 			if (CrtSts())
 			{			//if key hit...
@@ -266,9 +536,9 @@ void    main(void)
 
 			xmove = ymove = 0;
 
-                        // compute crt coord, using the start coord, the crt distance and the crt angle
-                        x = x0 + mult(delta, cos(angle));
-                        y = y0 + mult(delta, sin(angle));
+                        // compute crt coord, one step further along the angle
+                        x += xstep;
+                        y += ystep;
 
                         // if position changed ...
                         if (int_part(x) != int_part(xold) || int_part(y) != int_part(yold))
@@ -299,7 +569,7 @@ void    main(void)
                                 else
                                         angle = threePI - angle;
 
-                                delta = ONE_STEP;
+                                segment();
                         }
                         else if (xmove < 0 && int_part(x) == 0)
                         {
@@ -312,7 +582,7 @@ void    main(void)
                                 else
                                         angle = PI - angle;
 
-                                delta = ONE_STEP;
+                                segment();
                         }
                         else if (ymove != 0 &&
 				(int_part(y) == YMAX || int_part(y) == 0))
@@ -322,14 +592,10 @@ void    main(void)
 
                                 // compute new angle
                                 angle = twoPI - angle;
-                                delta = ONE_STEP;
-                        }
-                        else
-                        {
-                                delta += ONE_STEP;      // ... continue the movement using the old angle
+                                segment();
                         }
                 }
-                while (count2++ < 1000);
+                while (count2++ < TPS * SECONDS);
 next:;
         }
         while(count1++ < 10);
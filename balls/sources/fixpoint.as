@@ -3,13 +3,47 @@
 ;
 ;	Fixed point math
 ;
-        psect text
+;	shared by pool and balls (the master copy is in FPlib)
 ;
-;       Fixed point 8.8 format: 16 bits
+	psect text
+;
+;       Fixed point 8.8 format: 16 bitst
+
 ;       HIGH=int part
 ;       LOW=fract part
 ;
-;       int fpmul = mul(int pf1, int fp2)
+;	int neg(int fp)
+;
+_neg::
+	ld	hl,2
+	add	hl,sp
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)	
+__neg:
+    	xor 	a
+    	sub 	e
+    	ld 	e,a
+    	sbc 	a,a
+    	sub 	d
+    	ld 	d,a
+	ex	de,hl
+	ret
+;
+;	int positive(int fp)
+;
+_positive::
+	ld	hl,2
+	add	hl,sp
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)
+	bit	7,d
+	jr	nz,__neg	;if negative, negate-it
+	ex	de,hl		;else, keep-it unchanged
+	ret
+;
+;       int fpmul = mul(int fp1, int fp2)
 ;
 _mul::
         ld      hl,2
@@ -133,7 +167,7 @@ fpdiv::
         ld      a,b
         xor     d
         push    af
-        xor     b
+        xor     d
         jp      p,1f
         xor     a
         sub     c
@@ -194,250 +228,457 @@ div_sub:
         rla
         adc     hl,hl
         add     hl,de
-        jr      c,4f
+        jr      c,$+4
         sbc     hl,de
-4:
         djnz    3b
         adc     a,a
         ret
 
-BC_Times_DE:            ; unsigned BC*DE->BHLA
-        ld a,b
-        ld hl,0
-        ld b,h
-        add a,a
-        jr nc,$+5
-        ld h,d
-        ld l,e
-
-        REPT 7
-        add hl,hl
-        rla
-        jr nc,$+4
-        add hl,de
-        adc a,b
-        ENDM
-
-        push hl
-        ld h,b
-        ld l,b
-        ld b,a
-        ld a,c
-        ld c,h
-        add a,a
-        jr nc,$+5
-        ld h,d
-        ld l,e
+;	int	fpsqrt(int)
+_fpsqrt::
+	ld	hl,2
+	add	hl,sp
+	ld	c,(hl)
+	inc	hl
+	ld	b,(hl)
+;
+;	HL=sqrt(BC), BC unsigned
+;
+;	square root of BC*256 by the bitwise method : 12 bits of the root,
+;	2 bits of the radicand (BC, then 8 zeros) brought down per step
+;	the root is rounded to the nearest, without the divisions of the
+;	Newton steps (see fpbench.c for the timing)
+;
+fpsqrt::
+	ld	d,b
+	ld	e,c		;DE=radicand
+	ld	bc,0		;BC=2*root
+	ld	h,b
+	ld	l,c		;HL=remainder
+	ld	a,12
+1:
+	sla	e
+	rl	d
+	adc	hl,hl
+	sla	e
+	rl	d
+	adc	hl,hl		;remainder=remainder*4+next 2 bits
+	sla	c
+	rl	b
+	inc	c		;BC=4*root+1
+	or	a
+	sbc	hl,bc		;fits in the remainder ?
+	jr	nc,2f
+	add	hl,bc		;no, restore remainder
+	dec	c		;BC=2*(2*root)
+	jr	3f
+2:
+	inc	bc		;yes, BC=2*(2*root+1)
+3:
+	dec	a
+	jr	nz,1b
+	srl	b
+	rr	c		;BC=root
+	or	a
+	sbc	hl,bc		;remainder > root ?
+	jr	c,4f
+	jr	z,4f
+	inc	bc		;yes, round up
+4:
+	ld	h,b
+	ld	l,c
+	ret
+;
 
-        REPT 7
-        add hl,hl
-        rla
-        jr nc,$+4
-        add hl,de
-        adc a,c
-        ENDM
+halfPI		equ	192H
+PI		equ	324H
+twoPI		equ	648H
 
-        pop de
-        ld c,a
-        ld a,l
-        ld l,h
-        ld h,c
-        add hl,de
-        ret nc
-        inc b
-        ret
+;
+;	table lookup with linear interpolation
+;
+;	HL=table, DE=x (8.8, x >= 0)
+;	returns HL=table[x/4] + (table[x/4+1]-table[x/4])*(x%4)/4
+;
+;	the tables hold a value every 4/256, consecutive entries differ
+;	by less than 64
+;
+lookup:
+	ld	a,e
+	and	3
+	ld	c,a		;C=x%4
+	srl	d
+	rr	e
+	srl	d
+	rr	e		;DE=x/4
+	add	hl,de
+	add	hl,de		;HL=&table[x/4]
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)		;DE=table[x/4]
+	inc	hl
+	ld	a,(hl)
+	sub	e
+	ld	b,a		;B=table[x/4+1]-table[x/4]
+	xor	a
+	bit	0,c
+	jr	z,1f
+	add	a,b
+1:
+	bit	1,c
+	jr	z,2f
+	add	a,b
+	add	a,b		;A=B*(x%4)
+2:
+	add	a,2		;round
+	srl	a
+	srl	a
+	ld	l,a
+	ld	h,0
+	add	hl,de
+	ret
+;
+;	sintab[i] = sin(i/64), from 0 to PI/2 (quarter wave)
+;
+sintab:
 
-halfPI          equ     192H
-PI              equ     324H
-PIplus_halfPI   equ     4B6H
-twoPI           equ     648H
+	defw	0,4,8,12,16,20,24,28
+	defw	32,36,40,44,48,52,56,59
+	defw	63,67,71,75,79,83,86,90
+	defw	94,97,101,105,108,112,116,119
+	defw	123,126,130,133,137,140,143,147
+	defw	150,153,156,159,162,166,169,172
+	defw	174,177,180,183,186,189,191,194
+	defw	196,199,202,204,206,209,211,213
+	defw	215,218,220,222,224,226,227,229
+	defw	231,233,234,236,237,239,240,242
+	defw	243,244,245,246,248,248,249,250
+	defw	251,252,253,253,254,254,255,255
+	defw	255,256,256,256,256,256
+;
+;	atntab[i] = arctan(i/64), from 0 to 1
+;
+atntab:
 
+	defw	0,4,8,12,16,20,24,28
+	defw	32,36,40,44,47,51,55,59
+	defw	63,66,70,74,78,81,85,88
+	defw	92,95,99,102,106,109,112,115
+	defw	119,122,125,128,131,134,137,140
+	defw	143,146,149,151,154,157,160,162
+	defw	165,167,170,172,175,177,179,182
+	defw	184,186,188,191,193,195,197,199
+	defw	201,203
 ;
-;       int = sin(int fp)
+;	int = sin(int fp)
+;
+;	the angle is brought to [0,2PI), then to the quarter wave
+;	(no multiplication, as the polynomial needed)
 ;
 _sin::
-        ld      hl,2
-        add     hl,sp
-        ld      e,(hl)
-        inc     hl
-        ld      d,(hl)
-                        ;CARRY=0
-        ld      hl,halfPI-1     ;if angle < PI/2
-        sbc     hl,de
-        jr      nc,fpsin1       ;...compute sin(angle)
-
-        xor     a       ;CARRY=0
-        ld      hl,PI-1         ;if angle < PI
-        sbc     hl,de
-        inc     hl
-        jr      nc,fpsin2       ;...compute sin(PI-angle)
-
-        xor     a       ;CARRY=0
-        ld      hl,PIplus_halfPI-1;if angle < PI+PI/2
-        sbc     hl,de
-        jr      nc,fpsin3       ;...compute -sin(angle-PI)
-
-        xor     a       ;CARRY=0
-        ld      hl,twoPI        ;...else compute -sin(2PI-angle)
-        sbc     hl,de
-        call    fpsin2
-        jr      negate
-
-fpsin3:                 ;CARRY=0
-        ex      de,hl
-        ld      de,PI
-        sbc     hl,de
-        call    fpsin2
-negate:
-        ex      de,hl
-        xor     a
-        ld      hl,0
-        sbc     hl,de
-        ret
-
-fpsin2: ex      de,hl
-                        ;       x < PI/2
-                        ;       sin(x) : x-85x^3/512+x^5/128
-fpsin1:
-                        ;Inputs: DE , output: HL
-        push    de
-        sra     d
-        rr      e       ;DE=x/2
-        ld      b,d
-        ld      c,e
-        call    BC_Times_DE
-                        ;HL=x^2/4
-        push    hl
-        sra     h
-        rr      l       ;HL=x^2/8
-        ex      de,hl
-        ld      b,d
-        ld      c,e
-        call    BC_Times_DE
-                        ;HL=x^4/64
-        sra h
-        rr l
-        inc h
-        ex (sp),hl      ;x^4/128+1 is on stack, HL=x^2/4
-        xor a
-        ld d,a
-        ld b,h
-        ld c,l
-        add hl,hl
-        rla
-        add hl,hl
-        rla
-        add hl,bc
-        adc a,d
-        ld b,h
-        ld c,l
-        add hl,hl
-        rla
-        add hl,hl
-        rla
-        add hl,hl
-        rla
-        add hl,hl
-        rla
-        add hl,bc
-        adc a,d
-        ld e,l
-        ld l,h
-        ld h,a
-        rl e
-        adc hl,hl
-        rl e
-        jr nc,$+3
-        inc hl
-        pop de
-        ex de,hl
-        or a
-        sbc hl,de
-        ex de,hl
-        pop bc
-        jp BC_Times_DE
-
+	ld	hl,2
+	add	hl,sp
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)
+;
+;	HL=sin(DE)
 ;
-;       int = cos(int fp)
+fpsin::
+	bit	7,d		;angle < 0 ?
+	jr	z,2f
+	ld	hl,twoPI	;yes, add 2PI
+	add	hl,de
+	ex	de,hl
+	jr	fpsin
+1:
+	ex	de,hl		;DE=angle-2PI
+2:
+	ld	hl,-twoPI
+	add	hl,de		;angle >= 2PI ?
+	jr	c,1b		;yes, subtract 2PI
+	ld	hl,PI-1		;CARRY=0
+	sbc	hl,de		;if angle < PI
+	jr	nc,sinpos	;...compute sin(angle)
+	ex	de,hl		;...else compute -sin(angle-PI)
+	ld	de,PI
+	or	a
+	sbc	hl,de
+	ex	de,hl
+	call	sinpos
+	ex	de,hl
+	xor	a
+	ld	h,a
+	ld	l,a
+	sbc	hl,de
+	ret
+sinpos:				;DE on [0,PI)
+	ld	hl,halfPI	;CARRY=0
+	sbc	hl,de		;if angle > PI/2
+	jr	nc,1f
+	ld	hl,PI		;...use sin(PI-angle)
+	or	a
+	sbc	hl,de
+	ex	de,hl
+1:
+	ld	hl,sintab
+	jp	lookup
+;
+;	int = cos(int fp)
+;
+;	cos(x) = sin(x+PI/2)
 ;
 _cos::
-        ld      hl,2
-        add     hl,sp
-        ld      e,(hl)
-        inc     hl
-        ld      d,(hl)
-                        ;CARRY=0
-        ld      hl,halfPI-1     ;if angle < PI/2
-        sbc     hl,de
-        jr      nc,fpcos1       ;...compute cos(angle)
-
-        xor     a       ;CARRY=0
-        ld      hl,PI-1         ;if angle < PI
-        sbc     hl,de
-        inc     hl
-        jr      nc,fpcos2       ;...compute -cos(PI-angle)
-
-        xor     a       ;CARRY=0
-        ld      hl,PIplus_halfPI-1;if angle < PI+PI/2
-        sbc     hl,de
-        jr      nc,fpcos3       ;...compute -cos(angle-PI)
-
-        xor     a       ;CARRY=0
-        ld      hl,twoPI        ;...else compute cos(2PI-angle)
-        sbc     hl,de
-        ex      de,hl
-        jr      fpcos1
-
-fpcos3:                 ;CARRY=0
-        ex      de,hl
-        ld      de,PI
-        sbc     hl,de
-
-fpcos2: ex      de,hl
-        call    fpcos1
-        ex      de,hl
-        xor     a
-        ld      hl,0
-        sbc     hl,de
-        ret
-                        ;       x < PI/2
-                        ;       cos(x) : 1-x^2/2+5x^4/128
-fpcos1:
-                        ;Inputs: DE , output: HL
-        ld      b,d
-        ld      c,e
-        call    BC_Times_DE
-                        ;HL=x^2
-        sra     h
-        rr      l       ;HL=x^2/2
-        push    hl      ; x^2/2 on stack
-
-        ex      de,hl
-        ld      b,d
-        ld      c,e
-        call    BC_Times_DE
-                        ;HL=x^^4/4
+	ld	hl,2
+	add	hl,sp
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)
+;
+;	HL=cos(DE)
+;
+fpcos::
+	ld	hl,halfPI
+	add	hl,de
+	ex	de,hl
+	jr	fpsin
+;
+;	int	arctan(x)
+;
+;	x >=0
+;
+;	if x on [0,1]
+;		arctan(x) : from atntab
+;	else (x > 1)
+;		arctan(x) = halfPI - arctan(1/x)
+;
+_arctan::
+	ld	hl,2
+	add	hl,sp
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)		;DE=x
+				;x > 1 ?
+	ld	a,d
+	or	a
+	jr	z,arctan_1
+	dec	a
+	jr	nz,arctan_2
+	ld	a,e
+	or	a
+	jr	z,arctan_1
 
-        sra     h
-        rr      l       ;HL=x^^4/8
-        sra     h
-        rr      l       ;HL=x^^4/16
-        sra     h
-        rr      l       ;HL=x^^4/32
-        push    hl      ; x^^4/32 on stack
+arctan_2:			;x > 1
+	ld	bc,100H
+	call	fpdiv		;HL=1/x
+	ex	de,hl		;DE=1/x
+	call	arctan_1	;HL=atan(1/x)
+	ld	de,halfPI
+	ex	de,hl
+	or	a
+	sbc	hl,de		;HL=PI/2 - atan(1/x)
+	ret
 
-        sra     h
-        rr      l       ;HL=x^^4/64
-        sra     h
-        rr      l       ;HL=x^^4/128
+arctan_1:			;x <= 1
+	ld	hl,atntab
+	jp	lookup
 
-        pop     de
-        add     hl,de   ;HL=x^4/32 + x^4/128 = 5x^^4/128
 
-        pop     de
-        sbc     hl,de   ;HL=5x^^4/128 - x^2/2
+;	transform X/Y (X < Y) into fixed point
+;
+;int	xdivytofp(int x, int y);
+;
+_xdivytofp::
+	ld	hl,2
+	add	hl,sp
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)
+	inc	hl
+	ld	c,(hl)
+	inc	hl
+	ld	b,(hl)
+;
+;	X = DE, Y = BC
+;
+;	returns HL
+;
+xdivytofp::
+				;if X * 256 < Y, return 0
+	ld	a,d
+	or	a
+	jr	nz,ok
+	ld	h,e
+	ld	l,a		;HL=DE*256
+	ex	de,hl		;HL=X
+	ld	d,h
+	ld	e,l		;DE=X
+	sbc	hl,bc
+	jr	nc,ok
+	ld	hl,0		;return 0
+	ret
+ok:				;it will return a non-zero decimal part
+				;2*X >= Y ?
+	add	hl,hl		;HL=2*X
+	xor	a		;A=0, CARRY=0
+	sbc 	hl,bc
+	jr	c,1f
+	or	80H		;A=A or 80H
+				;X=2*X-Y
+	sla	c
+	rl	b		;Y=2*Y
+	jr	2f
+1:	ex	de,hl		;HL=X
+	ld	d,h
+	ld	e,l		;DE=X	
+2:				;4*X > Y ?
+	add	hl,hl
+	add	hl,hl		;HL=4*X
+	sbc 	hl,bc
+	jr	c,1f
+	or	40H		;A=A or 40H
+				;X=4*X-Y
+	sla	c
+	rl	b
+	sla	c
+	rl	b		;Y=4*Y
+	jr	2f
+1:	ex	de,hl		;HL=X
+	ld	d,h
+	ld	e,l		;DE=X
+2:				;8*X > Y ?
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl		;HL=8*X
+	sbc 	hl,bc		
+	jr	c,1f
+	or	20H		;A=A or 20H 
+				;X=8*X-Y
+	sla	c
+	rl	b
+	sla	c
+	rl	b
+	sla	c
+	rl	b		;Y=8*Y
+	jr	2f
+1:	ex	de,hl		;HL=X
+	ld	d,h
+	ld	e,l		;DE=X
+2:				;16*X > Y ?
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl		;HL=16*X
+	sbc 	hl,bc
+	jr	c,1f
+	or	10H		;A=A or 10H
+				;X=16*X-Y
+	sla	c
+	rl	b		
+	sla	c
+	rl	b
+	sla	c
+	rl	b
+	sla	c
+	rl	b		;Y=16*Y
+	jr	2f
+1:
+	ex	de,hl		;HL=X
+	ld	d,h
+	ld	e,l		;DE=X
+2:				;32*X > Y ?
+	add	hl,hl	
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl		;HL=32*X
+	sbc 	hl,bc
+	jr	c,1f
+	or	8H		;A=A or 8H
+				;X=32*X-Y
+	sla	c
+	rl	b		
+	sla	c
+	rl	b		
+	sla	c
+	rl	b
+	sla	c
+	rl	b
+	sla	c
+	rl	b		;Y=32*Y
+	jr	2f
+1:
+	ex	de,hl		;HL=X
+	ld	d,h
+	ld	e,l		;DE=X
+2:				;64*X > Y
+	add	hl,hl	
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl		;HL=64*X
+	sbc 	hl,bc
+	jr	c,1f
+	or	4H		;A=A or 4H
+				;X=64*X-Y
+	sla	c
+	rl	b		
+	sla	c
+	rl	b		
+	sla	c
+	rl	b		
+	sla	c
+	rl	b
+	sla	c
+	rl	b
+	sla	c
+	rl	b		;Y=64*Y
+	jr	2f
+1:
+	ex	de,hl		;HL=X
+	ld	d,h
+	ld	e,l		;DE=X
+2:				;128*X > Y
+	add	hl,hl	
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl
+	add	hl,hl		;HL=128*X
+	sbc 	hl,bc
+	jr	c,1f
+	or	2H		;A=A or 2H
+				;X=128*X-Y
+	sla	c
+	rl	b		
+	sla	c
+	rl	b		
+	sla	c
+	rl	b		
+	sla	c
+	rl	b		
+	sla	c
+	rl	b
+	sla	c
+	rl	b
+	sla	c
+	rl	b		;Y=128*Y
+	jr	2f
+1:
+	ex	de,hl		;HL=X
+2:				;256*X > Y
+	ld	h,l
+	ld	l,0
+	or	a
+	sbc	hl,bc
+	jr	c,1f
+	or	1H		;A=A or 1H
+1:	ld	h,0		;high part=0
+	ld	l,a		;low part
+	ret
+;
 
-        ld      bc,100h
-        add     hl,bc   ;HL=1 - x^2/2 + 5x^^4/128
-        ret
+	
 
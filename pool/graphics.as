@@ -8,6 +8,7 @@ Fonts_0_11:	defs	12 * 8
 
 	psect	data
 ;
+_WhiteSet::
 CUSTOM0:	defb	00111100B
 		defb	01111110B
 		defb	11111111B
@@ -108,6 +109,7 @@ CUSTOM10:	defb	00001000B
 		defb	00000000B
 ; second set
 
+_BlackSet::
 BCUSTOM0:	defb	00111100B
 		defb	01000010B
 		defb	10000001B
@@ -832,6 +834,35 @@ _Restore_0_to_11::
 	ld	e,12 * 8
 	jr	Load_12
 ;
+;void LoadGlyph(char slot, char* bitmap)
+;
+;	loads char 0x40 + slot (0...31) with the 8 bytes at bitmap
+;
+_LoadGlyph::
+	ld	hl,2
+	add	hl,sp
+	ld	a,(hl)			;A=slot
+	inc	hl
+	inc	hl
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)			;DE=bitmap
+	ex	de,hl
+	add	a,a
+	add	a,a
+	add	a,a
+	ld	b,a			;B=8 * slot
+	ld	c,0EH
+	ld	e,8
+1:
+	ld	a,(hl)
+	out	(c),a
+	inc	hl
+	inc	b
+	dec	e
+	jr	nz,1b
+	ret
+;
 ;void Load_CH(int XCHf, int YCHf)
 ;
 ;	loads char 0x4B with custom crosshair font
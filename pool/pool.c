@@ -17,6 +17,8 @@ int xdivytofp(int,int);
 int neg(int);
 int positive(int);
 
+char GetSeconds(void);
+
 void xrndseed(void);
 unsigned int xrnd(void);
 
@@ -32,6 +34,10 @@ void PrintStr(int,int,char*);
 void PrintChar(int y, int x, char ch);
 
 void Load_CH(int x, int y);
+void LoadGlyph(char slot, char* bitmap);
+
+extern char WhiteSet[];	// the ring shapes, 8 bytes each
+extern char BlackSet[];	// the solid shapes
 
 #define REV_BLANK	0x20+0x80
 
@@ -100,51 +106,50 @@ int X0, Y0, X1, Y1, XCH, YCH;
 int XCHf, YCHf;	//fractional part 0...3
 int pixelX, pixelY; // 0...7
 // XCH + XCHf/4, YCH + YCHf/4
-int x0, y0, x1, y1;	// fixed point
+int x0, y0, x1, y1;	// fixed point, cue ball & target ball
 int colX0, rowY0;
 int colX1, rowY1;
 int colCH, rowCH;
 int XCHfp, YCHfp;	// fixed point
-int xper, yper;		// fixed point
 
-char status;		// ball status
-#define BOUNCED 1
-#define BASKET 2
-#define STOPPED 3
-#define COLLIDED 4
-
-int speed;		// fixed point
+int speed;		// hit force, 1...25
 int angle;		// fixed point
-int alpha;		// fixed point
-int new_angle;		// fixed point
-
-char keep_speed;	// 1 = keep same speed at impact
 
-#define WHITE 0
-#define BLACK 1
-char moving_ball;	// 0 = white ball, 1 = black ball
+#define MAXBALLS 16	// the cue ball and a full rack of 15
+#define CUE 0		// balls[0] is the cue ball
+#define NONE 0xFF
 
-char bounce;		// 1 = bounce back
+#define TOUCH	0x300	// fp, distance between the centers of two touching balls
+#define TOUCH2	0x900	// fp, TOUCH squared
+#define STOPV	2	// fp, a ball slower than this (per tick) stops
 
-char collision_exp;	// 1 = collision expected
-int distance;		// fixed point
-int ddelta;		// fixed point
-int xp;			// fixed point
-int yp;			// fixed point
+struct ball
+{
+	int x, y;		// fixed point, center
+	int vx, vy;		// fixed point, speed per tick
+	int fx, fy;		// friction carried over, in 1/256 of the speed
+	char on;		// 1 = on the table
+	char moved;		// 1 = must be shown again
+	unsigned char col, row;	// where it is shown
+	unsigned char shape;	// sprite shape shown
+	unsigned char glyph;	// char used to show it, 0 = none
+	unsigned char next;	// next ball in the same grid cell
+};
 
-#define ONE_STEP 1
+struct ball balls[MAXBALLS];
+unsigned char nballs;	// cue ball + object balls
+unsigned char left;	// object balls still on the table
+unsigned char potted;	// object balls dropped by the last shot
+char scratch;		// 1 = the cue ball dropped in a pocket
+int startx[MAXBALLS], starty[MAXBALLS];	// fixed point, where the balls start
 
-int xstart, ystart;	//fp	start coord
-int xold, yold;         //fp    previous coord
-int xtmp, ytmp;         //fp    crt coord
-int incr;		// movement increment
-int xmove, ymove;
-int counter;		// speed related
-int init_counter;	// speed related
-int brake_counter;
+// broad phase: the table is cut in 16x16 cells, a ball can only touch
+// the balls of its own cell and of the 8 cells around
+#define GRIDW 8
+#define GRIDH 8
+#define CELL(x, y) ((((y) >> 12) << 3) + ((x) >> 12))
 
-int tmpX[128];
-int tmpY[128];
+unsigned char grid[GRIDW * GRIDH];	// first ball of each cell
 
 int RowToCoord[96] = //(low, high), (integer part*256 + fractional part)
 {
@@ -297,119 +302,31 @@ void fixedtoa(int fp, char* buf)
 	}
 }
 
-//
-// Choose one point with the lowest decimal part for Y,
-// given the vector:
-// X * tan(alpha) – Y + yp – xp * tan(alpha) = 0
-// and fill in coords for the white ball movement vector
-void Choose(int xp, int yp, int alpha)
-{
-	int n, max;
-	int x, y;
-	int tan;
-
-	if (moving_ball == BLACK)
-		return;
-
-	x0 = xp;
-	X0 = int_part(x0);
-	y0 = yp;
-	Y0 = int_part(y0);
-
-	tan = div(sin(alpha), cos(alpha));
+// virtual row (0...119) to screen row, and to the font index row part
+// ((row % 5) * 2), built once by InitRows from RowToCoord: placing a ball
+// on the screen takes a few table reads instead of a search
+// (RowToCoordLow & RowToCoordHigh give the way back)
+#define VROWS 120
 
-	max = 0;
-
-	for (n = 0; n < 128; n++)
-	{
-		x = n << 8;
-		y = mul(x, tan) - mul(xp, tan) + yp;
+unsigned char RealRow[VROWS];
+unsigned char RowPhase[VROWS];
+unsigned char FontIndex[10] = { 1, 3, 2, 4, 5, 8, 6, 10, 7, 9 };
 
-		if (y < 0)
-			continue;
-
-		tmpX[max] = x;
-		tmpY[max] = y;
-		max++;
-	}
-
-	XCHfp = tmpX[0];
-	YCHfp = tmpY[0];
-
-	if (max > 1)
-		for (n = 1; n < max; n++)
-			if ((YCHfp & 0xFF) > (tmpY[n] & 0xFF))
-			{
-				XCHfp = tmpX[n];
-				YCHfp = tmpY[n];
-				tmpY[n] = 0xFF;
-			}
-
-	XCH = int_part(XCHfp);
-	YCH = int_part(YCHfp);
-}
+#define VirtualToRealRow(vRow)		RealRow[vRow]
+#define GetFontIndex(vRow, vCol)	FontIndex[RowPhase[vRow] + ((vCol) & 1)]
 
-int VirtualToRealRow(int Row)
+void InitRows(void)
 {
-	int n=0;
+	unsigned char n = 0, v;
 
-	do
+	for (v = 0; v < VROWS; v++)
 	{
-		if (int_part(RowToCoord[n]) >= Row)
-			return n >> 1;
-
-		n++;
-	} while (1);
-}
-
-int RealToVirtualRow(int Row)
-{
-	int row_min = RowToCoordLow(Row);
-	int row_max = RowToCoordHigh(Row);
-
-	if (int_part(row_max) == int_part(row_min) + 1)
-		return int_part(row_min);
-	else
-		return int_part(row_min) + 1;
-}
-
-int GetFontIndex(int vRow, int vCol)
-{
-	int v = vRow % 5;
-	int x = vCol % 2;
-
-	if (v == 0)
-		return x == 0 ? 1 : 3;
-	else if (v == 1)
-		return x == 0 ? 2 : 4;
-	else if (v == 2)
-		return x == 0 ? 5 : 8;
-	else if (v == 3)
-		return x == 0 ? 6 : 10;
-	else
-		return x == 0 ? 7 : 9;
-}
+		while (int_part(RowToCoord[n]) < v)
+			n++;
 
-void show(int x, int y)
-{
-	PrintChar(VirtualToRealRow(y), (x/2), 0x40 + GetFontIndex(y, x));
-}
-
-void hide(int x, int y)
-{
-	PrintChar(VirtualToRealRow(y), (x/2), ' ');
-}
-
-// count = integer
-int mult(int count, int fpval)
-{
-        int ret=0;
-
-        do
-		ret += fpval;
-        while (--count);
-
-        return ret;
+		RealRow[v] = n >> 1;
+		RowPhase[v] = (v % 5) * 2;
+	}
 }
 
 void show_boundaries(void)
@@ -449,12 +366,118 @@ void show_boundaries(void)
 		PrintChar(i, 63, ' ');
 }
 
-void short_wait(void)
+// frame pacing: the physics runs TPS ticks per second and the balls are
+// drawn FPS times per second, whatever the CPU clock.
+// The only time base is the DS1302 (1 second resolution), so the frames
+// shown in each second are counted and the idle time of a frame is tuned
+// from the number of idle loops one second holds (measured at start)
+
+#define FPS	50		// frames per second
+#define TPS	250		// physics ticks per second
+#define MAXTICKS 20		// more ticks per frame would make the balls jump
+
+long spins;			// idle loops per second
+int idle;			// idle loops per frame
+int fps;			// frames shown in the last second
+int frames;			// frames shown in this second
+int tickacc;			// ticks due, in 1/fps units
+char second;			// current RTC second (BCD)
+char synced;			// a whole second was counted
+
+// counts the idle loops in one second, between two RTC second changes
+void CalibrateFrames(void)
 {
 	int i;
+	char s;
+
+	spins = 0;
+	s = GetSeconds();
 
-	for (i=0; i<500; i++)
+	while (GetSeconds() == s)
 		;
+
+	s = GetSeconds();
+
+	do
+	{
+		for (i = 0; i < 100; i++)
+			CrtSts();
+
+		spins += 100;
+	}
+	while (GetSeconds() == s);
+
+	idle = spins / FPS;
+}
+
+void StartFrames(void)
+{
+	fps = FPS;
+	frames = tickacc = 0;
+	second = GetSeconds();
+	synced = 0;
+}
+
+// the physics ticks due in this frame
+int FrameTicks(void)
+{
+	int n = 0;
+
+	tickacc += TPS;
+
+	while (tickacc >= fps)
+	{
+		tickacc -= fps;
+
+		if (n < MAXTICKS)	// too slow, play in slow motion
+			n++;
+	}
+
+	return n;
+}
+
+// the frame rate reached in the last second, on the top line
+// ("slow" when the ticks are capped, the balls then move in slow motion)
+void ShowRate(void)
+{
+	char rate[16];
+
+	sprintf(rate, "%2d fps %s", fps, fps * MAXTICKS < TPS ? "slow" : "    ");
+	PrintStr(47, 53, rate);
+}
+
+// ends a frame: the idle time polls the keyboard,
+// then at each new second the idle time is retuned
+void EndFrame(void)
+{
+	int i;
+	char s;
+
+	for (i = 0; i < idle; i++)
+		if (CrtSts())
+			break;
+
+	frames++;
+	s = GetSeconds();
+
+	if (s == second)
+		return;
+
+	second = s;
+
+	if (synced)
+	{
+		fps = frames;
+		idle += spins / FPS - spins / fps;
+
+		if (idle < 0)
+			idle = 0;
+
+		ShowRate();
+	}
+
+	synced = 1;
+	frames = 0;
 }
 
 char CheckYBasket(int v)
@@ -473,275 +496,508 @@ char CheckXBasket(int v)
 		return 0;
 }
 
-void SetWhiteBallSafeCoord(void)
+//
+// determine coord for the two balls, when playing with one target
+// (x1,y1) is the target
+//
+void get_balls_coord(void)
+{
+	// get random (x0,y0)
+	_X0 = 2 * (xrnd() % ((XMAX-XMIN)/2)) + XMIN + 1;
+	_Y0 = 2 * (xrnd() % ((TYMAX-TYMIN)/2)) + TYMIN + 1;
+
+	// choose (x1,y1) so that |x0-x1| > BALLS_GAP and |y0-y1| > BALLS_GAP
+	do
+		_X1 = 2 * (xrnd() % ((TXMAX-TXMIN)/2)) + TXMIN + 1;
+	while (abs(_X0 - _X1) < BALLS_GAP);
+
+	do 
+		_Y1 = 2 * (xrnd() % ((TYMAX-TYMIN)/2)) + TYMIN + 1;
+	while (abs(_Y0 - _Y1) < BALLS_GAP);
+
+	_x0 = _X0 << 8;
+	_y0 = _Y0 << 8;
+
+	_x1 = _X1 << 8;
+	_y1 = _Y1 << 8;
+}
+
+//
+// Multi-ball physics
+//
+// fixed timestep: at each tick every moving ball advances by its speed
+// (at most 1 pixel), the cushions and pockets are checked, then the
+// collisions, and friction takes 1/256 of the speed
+//
+
+//
+// Sprites
+//
+// a ball is drawn by a glyph showing it at one of 10 places in the cell
+// (GetFontIndex); the cue ball is a ring, the others are solid.
+// 0x40 (solid) and 0x41 (ring) always hold the ball on a cell boundary,
+// the other slots up to 0x4A get the shifted shapes on demand, and keep
+// them while they are not used: a slot is loaded (8 bytes) only when it
+// gets a new shape. If all the slots are taken, the boundary glyph is used
+// (0x4B is the crosshair)
+//
+#define RING	0x00
+#define SOLID	0x10
+#define SLOTS	11	// 0x40 ... 0x4A
+#define FIXED	2	// 0x40 & 0x41 are never loaded again
+
+unsigned char slotshape[SLOTS] =	// as loaded by Load_0_to_10
+{
+	SOLID | 1, RING | 1, RING | 2, RING | 3, RING | 4, RING | 5,
+	RING | 6, RING | 7, RING | 8, RING | 9, RING | 10
+};
+unsigned char slotrefs[SLOTS];		// balls shown using each slot
+
+// returns the glyph showing shape, loading a free slot if needed
+unsigned char GetGlyph(unsigned char shape)
 {
-	int X,Y;
+	unsigned char i, free = NONE;
 
-	X = int_part(xtmp);
-	Y = int_part(ytmp);
+	for (i = 0; i < SLOTS; i++)
+		if (slotshape[i] == shape)
+		{
+			slotrefs[i]++;
+			return 0x40 + i;
+		}
+		else if (i >= FIXED && slotrefs[i] == 0 && free == NONE)
+			free = i;
 
-	hide(X, Y);
+	if (free == NONE)
+		return (shape & SOLID) ? 0x40 : 0x41;
 
-	colX0 = X / 2;
-	rowY0 = VirtualToRealRow(Y);
+	LoadGlyph(free, ((shape & SOLID) ? BlackSet : WhiteSet) + (shape & 0x0F) * 8);
+	slotshape[free] = shape;
+	slotrefs[free] = 1;
 
-	X0 = colX0 * 2;
-	x0 = X0 << 8;
-	Y0 = RealToVirtualRow(rowY0);
-	y0 = Y0 << 8;
+	return 0x40 + free;
 }
 
-void SetBlackBallSafeCoord(void)
+void DropGlyph(unsigned char glyph)
 {
-	int X,Y;
+	if (glyph >= 0x40 && glyph < 0x40 + SLOTS && slotrefs[glyph - 0x40])
+		slotrefs[glyph - 0x40]--;
+}
+
+// the ball shown at (row, col), or NONE
+unsigned char BallAt(int row, int col)
+{
+	struct ball *b;
+	unsigned char i;
 
-	X = int_part(xtmp);
-	Y = int_part(ytmp);
+	for (i = 0, b = balls; i < nballs; i++, b++)
+		if (b->on && b->row == row && b->col == col)
+			return i;
 
-	hide(X, Y);
+	return NONE;
+}
 
-	colX1 = X / 2;
-	rowY1 = VirtualToRealRow(Y);
+// the aim preview (see ShowPath): the cells holding a dot, one bit each
+unsigned char pathmap[2][48 * 8];
+unsigned char curmap;			// pathmap[curmap] is on the screen
+unsigned char ghostrow, ghostcol = NONE;	// where the ghost ball is shown
+unsigned char bit[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
 
-	X1 = colX1 * 2;
-	x1 = X1 << 8;
-	Y1 = RealToVirtualRow(rowY1);
-	y1 = Y1 << 8;
+#define ONPATH(map, row, col)	(map[((row) << 3) + ((col) >> 3)] & bit[(col) & 7])
+
+// clears a cell, or shows again the ball (or the aim preview) it holds
+void RestoreCell(int row, int col)
+{
+	unsigned char i = BallAt(row, col);
+
+	if (i != NONE)
+		PrintChar(row, col, balls[i].glyph);
+	else if (row == ghostrow && col == ghostcol)
+		PrintChar(row, col, 0x41);
+	else if (ONPATH(pathmap[curmap], row, col))
+		PrintChar(row, col, '.');
+	else
+		PrintChar(row, col, ' ');
 }
 
-//
-// Moves a ball from (xstart, ystart) at angle
-//
-// xstart, ystart, angle
-// counter, init_counter & brake counter must be set
-//
-// returns 
-//	BOUNCED if ball hit the boundaries
-//	BASKET if ball drops to basket
-//	STOPPED if ball stopped
-//
-char move_ball(void)
+// shows the balls which moved to another cell or sprite shape: all the
+// old cells are cleared first, so that a ball entering a cell just left
+// by another one is not erased (and a slot is loaded only when it is
+// no more on the screen)
+void ShowBalls(void)
 {
-	//start moving the ball
-	incr = ONE_STEP;
-		
-	xold = xstart;
-	yold = ystart;
+	struct ball *b;
+	unsigned char i, col, row, shape;
+	unsigned char changed[MAXBALLS];
+	int X, Y;
 
-	do
+	for (i = 0, b = balls; i < nballs; i++, b++)
 	{
-		short_wait();           // wait a little for each step, then...
-			
-		counter--;		// decrement counter
+		changed[i] = 0;
 
-		if (counter == 0)
-		{			// move the ball
-					// first, apply brake rules (each 10 movements, speed decreases...)
-			brake_counter--;
+		if (!b->on || !b->moved)
+			continue;
+
+		b->moved = 0;
+
+		X = int_part(b->x);
+		Y = int_part(b->y);
+
+		col = X / 2;
+		row = VirtualToRealRow(Y);
+		shape = ((i == CUE) ? RING : SOLID) | GetFontIndex(Y, X);
+
+		if (col != b->col || row != b->row || shape != b->shape)
+		{
+			if (b->col != NONE)
+				PrintChar(b->row, b->col, ' ');
 
-			if (brake_counter == 0)
+			b->col = col;
+			b->row = row;
+			changed[i] = 1;
+
+			if (shape != b->shape)
 			{
-				brake_counter = 10;
-				init_counter++;
-				speed--;
-
-				if (speed == 0)
-				{
-					if (moving_ball == WHITE)
-					{
-						SetWhiteBallSafeCoord();
-						PrintChar(rowY0, colX0, 0x41);
-					}
-					else
-					{
-						SetBlackBallSafeCoord();
-						PrintChar(rowY1, colX1, 0x41);
-					}
-
-					return STOPPED;
-				}
+				b->shape = shape;
+				changed[i] = 2;
 			}
+		}
+	}
 
-			counter = init_counter;
+	for (i = 0, b = balls; i < nballs; i++, b++)
+		if (changed[i] == 2)
+		{
+			DropGlyph(b->glyph);
+			b->glyph = GetGlyph(b->shape);
+		}
 
-			xmove = ymove = 0;
+	for (i = 0, b = balls; i < nballs; i++, b++)
+		if (changed[i])
+			PrintChar(b->row, b->col, b->glyph);
+}
 
-                       	// compute crt coord, using the start coord, the crt distance and the crt angle
-                       	xtmp = xstart + mult(incr, cos(angle));
-                       	ytmp = ystart + mult(incr, sin(angle));
+void Pocket(struct ball *b)
+{
+	if (b->col != NONE)
+		PrintChar(b->row, b->col, ' ');
 
-                       	// if position changed ...
-                       	if (int_part(xtmp) != int_part(xold) || int_part(ytmp) != int_part(yold))
-                       	{
-       				xmove = int_part(xtmp) - int_part(xold);
-				ymove = int_part(ytmp) - int_part(yold);
-			}
+	DropGlyph(b->glyph);
+	b->glyph = b->shape = 0;
 
-                       	// handle hitting the boundaries
-                       	if (xmove > 0 && int_part(xtmp) >= XMAX)
-                       	{
-				if (CheckYBasket(int_part(ytmp)))
-					return BASKET;
+	b->on = 0;
+	b->vx = b->vy = 0;
 
-				xstart = xold;          		// set new start coord
-				ystart = yold;
+	if (b == balls)
+		scratch = 1;
+	else
+	{
+		potted++;
+		left--;
+	}
+}
 
-				// compute new angle
-				if (angle < halfPI)
-                      	    		angle = PI - angle;
-				else
-					angle = threePI - angle;
+// bounces the ball back from the rim, or drops it in a pocket
+void Cushions(struct ball *b)
+{
+	int X = int_part(b->x);
+	int Y = int_part(b->y);
 
-				Choose(xstart, ystart, angle);
+	if ((X <= XMIN && b->vx < 0) || (X >= XMAX && b->vx > 0))
+	{
+		if (CheckYBasket(Y))
+		{
+			Pocket(b);
+			return;
+		}
 
-				return BOUNCED;
-                       	}
-			else if (xmove < 0 && int_part(xtmp) <= XMIN)
-			{
-				if (CheckYBasket(int_part(ytmp)))
-					return BASKET;
+		b->vx = -b->vx;
+	}
 
-                                xstart = xold;          		// set new start coord
-                               	ystart = yold;
+	if ((Y <= YMIN && b->vy < 0) || (Y >= YMAX && b->vy > 0))
+	{
+		if (CheckXBasket(X))
+		{
+			Pocket(b);
+			return;
+		}
 
-                               	// compute new angle
-                               	if (angle > PI)
-                                     	angle = threePI - angle;
-                               	else
-                                       	angle = PI - angle;
-
-				Choose(xstart, ystart, angle);
+		b->vy = -b->vy;
+	}
+}
 
-				return BOUNCED;
-                       	}
-                       	else if (ymove != 0 && int_part(ytmp) <= YMIN)
-                       	{
-				if (CheckXBasket(int_part(xtmp)))
-					return BASKET;
+// elastic collision of two balls of the same mass: the components of
+// their speeds along the line of centers are exchanged
+void Collide(struct ball *a, struct ball *b)
+{
+	int dx, dy, d, nx, ny, vn;
 
-                                xstart = xold;          		// set new start coord
-                               	ystart = yold;
+	if (!(a->vx || a->vy || b->vx || b->vy))
+		return;		// both still
 
-                               	// compute new angle
-                               	angle = twoPI - angle;
+	dx = b->x - a->x;
+	dy = b->y - a->y;
 
-				Choose(xstart, ystart, angle);
+	if (abs(dx) >= TOUCH || abs(dy) >= TOUCH)
+		return;
 
-				return BOUNCED;
-                       	}
-                       	else if (ymove != 0 && int_part(ytmp) >= YMAX)
-                       	{
-				if (CheckXBasket(int_part(xtmp)))
-					return BASKET;
+	d = mul(dx, dx) + mul(dy, dy);
 
-                                xstart = xold;          		// set new start coord
-                               	ystart = yold;
+	if (d >= TOUCH2)
+		return;
 
-                               	// compute new angle
-                               	angle = twoPI - angle;
+	// moving apart ?
+	if ((long)(a->vx - b->vx) * dx + (long)(a->vy - b->vy) * dy <= 0)
+		return;
 
-				Choose(xstart, ystart, angle);
+	d = fpsqrt(d);
 
-				return BOUNCED;
-                       	}
-                       	else
-                       	{
-				hide(int_part(xold), int_part(yold));
-				xold = xtmp;
-				yold = ytmp;
-				show(int_part(xtmp), int_part(ytmp));
+	if (d == 0)
+		return;
 
-				if (moving_ball == WHITE)
-					PrintChar(rowY1, colX1, 0x40);
-				else
-					PrintChar(rowY0, colX0, 0x40);
+	nx = div(dx, d);	// unit vector, from a to b
+	ny = div(dy, d);
 
-                               	incr += ONE_STEP;      // ... continue the movement using the old angle
-                       	}
+	vn = mul(a->vx - b->vx, nx) + mul(a->vy - b->vy, ny);
 
-			if (xmove != 0 || ymove != 0)
-			{	// if ball moved...
-				// check distance between balls
-				if ((moving_ball == WHITE) && (collision_exp == 1) && 
-				    (abs(xtmp - x1) < 0x300 && abs(ytmp - y1) < 0x300))
-				{
-					// collision !
-					// only impacted ball (black) will move...
+	if (vn <= 0)
+	{			// too slow to share, b takes the speed of a
+		dx = a->vx;
+		dy = a->vy;
+		a->vx = b->vx;
+		a->vy = b->vy;
+		b->vx = dx;
+		b->vy = dy;
+		return;
+	}
 
-					SetWhiteBallSafeCoord();
+	dx = mul(vn, nx);
+	dy = mul(vn, ny);
 
-					collision_exp = 0;	
+	a->vx -= dx;
+	a->vy -= dy;
+	b->vx += dx;
+	b->vy += dy;
+}
 
-					// impacted ball (black) will start from (x1,y1)... 
-					xstart = x1;
-					ystart = y1;
+void Collisions(void)
+{
+	struct ball *a;
+	unsigned char i, j, c, cx, cy, gx, gy;
 
-					if (!keep_speed)
-					{
-						angle = new_angle; //using new angle
+	memset(grid, NONE, sizeof(grid));
 
-						// with an initial speed = speed * cos(alpha)
+	for (i = 0, a = balls; i < nballs; i++, a++)
+		if (a->on)
+		{
+			c = CELL(a->x, a->y);
+			a->next = grid[c];
+			grid[c] = i;
+		}
 
-						speed = int_part( positive(mult(speed, cos(alpha))) );
+	for (i = 0, a = balls; i < nballs; i++, a++)
+	{
+		if (!a->on)
+			continue;
 
-						if (speed == 0)
-							return STOPPED;
-					}
+		gx = a->x >> 12;
+		gy = a->y >> 12;
 
-					// change fonts, show white ball as a static ball
-					moving_ball = BLACK;
-					BLoad_0_to_10(); // load fonts for the black ball
+		for (cy = gy ? gy - 1 : 0; cy <= gy + 1 && cy < GRIDH; cy++)
+			for (cx = gx ? gx - 1 : 0; cx <= gx + 1 && cx < GRIDW; cx++)
+				for (j = grid[(cy << 3) + cx]; j != NONE; j = balls[j].next)
+					if (j > i)
+						Collide(a, &balls[j]);
+	}
+}
 
-					PrintChar(rowY0, colX0, 0x40);
-					PrintChar(rowY1, colX1, 0x41);
+// one timestep, returns the number of balls still moving
+unsigned char Tick(void)
+{
+	struct ball *b;
+	unsigned char i, moving = 0;
 
-					init_counter = counter = 26 - speed; 	//set up speed control
-					brake_counter = 10;			//set up brake control
+	for (i = 0, b = balls; i < nballs; i++, b++)
+		if (b->on && (b->vx || b->vy))
+		{
+			b->x += b->vx;
+			b->y += b->vy;
+			b->moved = 1;
+			Cushions(b);
+		}
 
-					return COLLIDED;
-				}
-				else if ((moving_ball == BLACK) && (status == BOUNCED) &&
-				         (abs(xtmp - x1) < 0x300 && abs(ytmp - y1) < 0x300))
-				{
-					//stop black ball
-					SetBlackBallSafeCoord();
-
-					moving_ball = WHITE;
-					Load_0_to_10(); // load fonts for the white ball
-					PrintChar(rowY1, colX1, 0x40);	//black ball
-					PrintChar(rowY0, colX0, 0x41);	//white ball
+	Collisions();
 
-					return STOPPED;
-				}
-			}
+	for (i = 0, b = balls; i < nballs; i++, b++)
+		if (b->on && (b->vx || b->vy))
+		{
+			// the parts of 1/256 are carried over, so that
+			// the slow balls keep slowing down
+			b->fx += b->vx;
+			b->vx -= b->fx >> 8;
+			b->fx &= 0xFF;
+
+			b->fy += b->vy;
+			b->vy -= b->fy >> 8;
+			b->fy &= 0xFF;
+
+			if (abs(b->vx) < STOPV && abs(b->vy) < STOPV)
+				b->vx = b->vy = 0;
+			else
+				moving++;
 		}
-	} while(1);
+
+	return moving;
 }
 
-//
-// determine coord for the two balls
-// (x1,y1) is the target
-//
-void get_balls_coord(void)
+// hits the cue ball at angle, then runs the balls until they all stop
+void Shoot(void)
 {
-	// get random (x0,y0)
-	_X0 = 2 * (xrnd() % ((XMAX-XMIN)/2)) + XMIN + 1;
-	_Y0 = 2 * (xrnd() % ((TYMAX-TYMIN)/2)) + TYMIN + 1;
+	struct ball *b = balls;
+	int n;
+	char moving = 1;
+
+	// force 25 = 1 pixel per tick
+	b->vx = cos(angle) * speed / 25;
+	b->vy = sin(angle) * speed / 25;
+	b->fx = b->fy = 0;
+
+	potted = scratch = 0;
+
+	StartFrames();
 
-	// choose (x1,y1) so that |x0-x1| > BALLS_GAP and |y0-y1| > BALLS_GAP
 	do
-		_X1 = 2 * (xrnd() % ((TXMAX-TXMIN)/2)) + TXMIN + 1;
-	while (abs(_X0 - _X1) < BALLS_GAP);
+	{
+		for (n = FrameTicks(); n; n--)
+			if (!(moving = Tick()))
+				break;
 
-	do 
-		_Y1 = 2 * (xrnd() % ((TYMAX-TYMIN)/2)) + TYMIN + 1;
-	while (abs(_Y0 - _Y1) < BALLS_GAP);
+		ShowBalls();
+		EndFrame();
+	}
+	while (moving);
+}
 
-	_x0 = _X0 << 8;
-	_y0 = _Y0 << 8;
+void PutBall(unsigned char i, int x, int y)
+{
+	struct ball *b = &balls[i];
+
+	b->x = x;
+	b->y = y;
+	b->vx = b->vy = 0;
+	b->on = 1;
+	b->moved = 1;
+	b->col = NONE;
+	DropGlyph(b->glyph);
+	b->glyph = b->shape = 0;
+}
 
-	_x1 = _X1 << 8;
-	_y1 = _Y1 << 8;
+// the start positions: with one object ball, random places (as before),
+// else the cue ball on the left and the object balls racked in a
+// triangle on the right, 3 pixels apart
+void SetBalls(void)
+{
+	unsigned char i, row, n;
+
+	if (nballs == 2)
+	{
+		get_balls_coord();
+		startx[CUE] = _x0;
+		starty[CUE] = _y0;
+		startx[1] = _x1;
+		starty[1] = _y1;
+		return;
+	}
+
+	startx[CUE] = 31 << 8;
+	starty[CUE] = 58 << 8;
+
+	for (i = 1, row = 0; i < nballs; row++)
+		for (n = 0; n <= row && i < nballs; n++, i++)
+		{
+			startx[i] = (89 + 3 * row) << 8;
+			starty[i] = ((58 + 3 * n) << 8) - row * 0x180;
+		}
+}
+
+void PlaceBalls(void)
+{
+	unsigned char i;
+
+	for (i = 0; i < nballs; i++)
+		PutBall(i, startx[i], starty[i]);
+
+	left = nballs - 1;
+}
+
+// back on its start place (or further right, if it is taken)
+void SpotCue(void)
+{
+	struct ball *b;
+	unsigned char i;
+	int x = startx[CUE], y = starty[CUE];
+
+again:
+	for (i = 1, b = &balls[1]; i < nballs; i++, b++)
+		if (b->on && abs(b->x - x) < TOUCH + 0x100 && abs(b->y - y) < TOUCH + 0x100)
+		{
+			x += 0x400;
+
+			if (int_part(x) > XMAX - 2)
+				x = (XMIN + 2) << 8;
+
+			goto again;
+		}
+
+	PutBall(CUE, x, y);
+}
+
+// sets the cue ball & target ball coords used to aim: the target is
+// the object ball nearest to the cue ball
+void SetAim(void)
+{
+	struct ball *b;
+	unsigned char i, target = 1;
+	int d, dmin = 0x7FFF;
+
+	for (i = 1, b = &balls[1]; i < nballs; i++, b++)
+		if (b->on)
+		{
+			d = abs(int_part(b->x) - int_part(balls[CUE].x)) +
+			    abs(int_part(b->y) - int_part(balls[CUE].y));
+
+			if (d < dmin)
+			{
+				dmin = d;
+				target = i;
+			}
+		}
+
+	x0 = balls[CUE].x;
+	y0 = balls[CUE].y;
+	X0 = int_part(x0);
+	Y0 = int_part(y0);
+	colX0 = balls[CUE].col;
+	rowY0 = balls[CUE].row;
+
+	x1 = balls[target].x;
+	y1 = balls[target].y;
+	X1 = int_part(x1);
+	Y1 = int_part(y1);
+	colX1 = balls[target].col;
+	rowY1 = balls[target].row;
+}
+int chX = -1, chY = -1;	// crosshair shape loaded in 0x4B
+
+// shows the crosshair, its glyph is loaded only when its shape changed
+void ShowCH(void)
+{
+	if (pixelX != chX || pixelY != chY)
+	{
+		Load_CH(pixelX, pixelY);
+		chX = pixelX;
+		chY = pixelY;
+	}
+
+	PrintChar(rowCH, colCH, 0x4B);
 }
 
 // use custom fonts for '+', return also XCHf, YCHf
@@ -784,8 +1040,7 @@ void get_cross_coord(void)
 	}
 
 	pixelX = pixelY = 4;
-	Load_CH(pixelX, pixelY);
-	PrintChar(rowCH, colCH, 0x4B);
+	ShowCH();
 
 	XCHf = 0;
 	XCH = colCH * 2 + 1;
@@ -814,7 +1069,7 @@ void move_up_ch(void)
 
 	if (pixelY == 7)
 	{
-		if (rowCH < 45 && ((rowCH + 1 != rowY0) || (colCH != colX0)) && ((rowCH + 1 != rowY1) || (colCH != colX1)))
+		if (rowCH < 45 && BallAt(rowCH + 1, colCH) == NONE)
 		{
 			rowCH = rowCH + 1;
 			row = RowToCoordLow(rowCH);
@@ -845,7 +1100,7 @@ void move_down_ch(void)
 
 	if (pixelY == 0)
 	{
-		if (rowCH > 1 && ((rowCH - 1 != rowY0) || (colCH != colX0)) && ((rowCH - 1 != rowY1) || (colCH != colX1)))
+		if (rowCH > 1 && BallAt(rowCH - 1, colCH) == NONE)
 		{
 			rowCH = rowCH - 1;
 			row = RowToCoordHigh(rowCH);
@@ -874,7 +1129,7 @@ void move_left_ch(void)
 {
 	if (pixelX == 0)
 	{
-		if (colCH > 1 && ((colCH - 1 != colX0) || (rowCH != rowY0)) && ((colCH - 1 != colX1) || (rowCH != rowY1)))
+		if (colCH > 1 && BallAt(rowCH, colCH - 1) == NONE)
 		{
 			colCH--;
 			XCH--;
@@ -902,7 +1157,7 @@ void move_right_ch(void)
 {
 	if (pixelX == 7)
 	{
-		if (colCH < 62 && ((colCH + 1 != colX0) || (rowCH != rowY0)) && ((colCH + 1 != colX1) || (rowCH != rowY1)))
+		if (colCH < 62 && BallAt(rowCH, colCH + 1) == NONE)
 		{
 			colCH++;
 			XCH++;
@@ -929,7 +1184,7 @@ void move_right_ch(void)
 //returns 1 if CR was hit
 char MoveCH(char dir)
 {
-	PrintChar(rowCH, colCH, ' ');
+	RestoreCell(rowCH, colCH);
 
 	switch (dir)
 	{
@@ -940,118 +1195,11 @@ char MoveCH(char dir)
 	default:	break;
 	}
 
-	Load_CH(pixelX, pixelY);
-	PrintChar(rowCH, colCH, 0x4B);
+	ShowCH();
 
 	return (dir == 0xD) ? 1 : 0;
 }
 
-int tofp(int x, int y)
-{
-	int intp, modulo;
-
-	if (x < y)
-		return xdivytofp(x, y);
-
-	intp = (x / y) << 8;
-
-	modulo = x % y;
-
-	if (modulo == 0)
-		return intp;
-	else
-		return intp + xdivytofp(modulo, y);
-}
-
-int vxdivytofp(long x, long y)
-{
-	if ((x & 0xFFFF0000) || (y & 0xFFFF0000))
-		return xdivytofp((int)(x >> 16), (int)(y >> 16));
-	else
-		return xdivytofp((int)(x & 0xFFFF), (int)(y & 0xFFFF));
-}
-
-int ltofp(long x, long y)
-{
-	long lintp;
-	long modulo;
-	int intp;
-
-	if (x < y)
-		return vxdivytofp(x, y);
-
-	lintp = x / y;
-	intp = (int)(lintp & 0xFFFF);
-	modulo = x - y * lintp;
-
-	if (modulo == 0)
-		return (intp << 8);
-	else
-		return (intp << 8) + vxdivytofp(modulo, y);
-}
-
-//
-// Compute distance from a point(xp,yp) to a line(x1,y1,x2,y2)
-// x2+x2f/4,y2+y2f/4
-int DistanceTo(int xp, int yp, int x1, int y1, int x2, int x2f, int y2, int y2f)
-{
-	int a = 4*y1 - 4*y2 - y2f;
-	int b = 4*x2 + x2f - 4*x1;
-	int c = x1*(4*y2 + y2f) - (4*x2 + x2f)*y1;
-	int f;
-	long ff;
-	long tmp;
-	long aprox;
-	int dd;
-
-	f = abs(a*xp + b*yp + c);
-	ff = (long)f*(long)f;
-	tmp = (long)a*(long)a + (long)b*(long)b;
-
-	aprox = ff / tmp;	//try rough estimate...
-
-	if (aprox > 4)		//distance > 2
-		return 0x201;
-				//distance < 2, compute-it
-	dd = ltofp(ff, tmp);
-
-	return fpsqrt(dd);
-}
-
-//
-// Compute the X coordinate of the intersection of the perpendicular from a point(xp,yp) on a line(x1,y1,x2,y2)
-// x2+x2f/4,y2+y2f/4
-int Xper(int xp, int yp, int x1, int y1, int x2, int x2f, int y2, int y2f)
-{
-	int a = 4*y1 - 4*y2 - y2f;
-	int b = 4*x2 + x2f - 4*x1;
-	int c = x1*(4*y2 + y2f) - (4*x2 + x2f)*y1;
-	int tmp;
-	long s;
-
-	tmp = a*a + b*b;
-	s = (long)b*(long)b*(long)xp - (long)a*(long)b*(long)yp - (long)a*(long)c;
-
-	return ltofp(s, (long)tmp);
-}
-
-//
-// Compute the Y coordinate of the intersection of the perpendicular from a point(xp,yp) on a line(x1,y1,x2,y2)
-// x2+x2f/4,y2+y2f/4
-int Yper(int xp, int yp, int x1, int y1, int x2, int x2f, int y2, int y2f)
-{
-	int a = 4*y1 - 4*y2 - y2f;
-	int b = 4*x2 + x2f - 4*x1;
-	int c = x1*(4*y2 + y2f) - (4*x2 + x2f)*y1;
-	int tmp;
-	long s;
-
-	tmp = a*a + b*b;
-	s = (long)a*(long)a*(long)yp - (long)a*(long)b*(long)xp - (long)b*(long)c;
-
-	return ltofp(s, (long)tmp);
-}
-
 //
 // compute angle for vector [(xa,ya),(xb,yb)]
 //
@@ -1099,23 +1247,186 @@ int ComputeAngle(int xa, int ya, int xb, int yb)	//fixed point
 	return angle;
 }
 
+//
+// Aim preview
+//
+// the cue ball path is followed with the motion model of Tick (1 pixel
+// steps, same cushions), up to the second cushion, a pocket, or the first
+// object ball it would touch, where the ghost ball (0x41) is shown.
+// A dot is put every DOTGAP pixels; when the crosshair moves only the
+// dots which changed are drawn or erased
+//
+#define PATHLEN	250	// pixels followed at most
+#define DOTGAP	4
+#define MAXDOTS	(PATHLEN / DOTGAP + 1)
+
+char Preview;		// 1 = show the path ('p' toggles it)
+unsigned char ndots;
+unsigned char dotrow[MAXDOTS], dotcol[MAXDOTS];
+
+// the object ball the cue ball at (x, y) would touch, or NONE
+unsigned char Contact(int x, int y)
+{
+	struct ball *b;
+	unsigned char i;
+	int dx, dy;
+
+	for (i = 1, b = &balls[1]; i < nballs; i++, b++)
+		if (b->on)
+		{
+			dx = b->x - x;
+			dy = b->y - y;
+
+			if (abs(dx) < TOUCH && abs(dy) < TOUCH &&
+			    mul(dx, dx) + mul(dy, dy) < TOUCH2)
+				return i;
+		}
+
+	return NONE;
+}
+
+// follows the path, fills the new map & dots, returns the ghost cell
+// (col = NONE if no ball is touched)
+void FollowPath(unsigned char *map, unsigned char *grow, unsigned char *gcol)
+{
+	int x = x0, y = y0, vx, vy, X, Y, n;
+	unsigned char row, col, bounces = 0;
+
+	angle = ComputeAngle(x0, y0, XCHfp, YCHfp);
+	vx = cos(angle);
+	vy = sin(angle);
+
+	ndots = 0;
+	*gcol = NONE;
+
+	for (n = 1; n <= PATHLEN; n++)
+	{
+		x += vx;
+		y += vy;
+		X = int_part(x);
+		Y = int_part(y);
+
+		if ((X <= XMIN && vx < 0) || (X >= XMAX && vx > 0))
+		{
+			if (CheckYBasket(Y) || bounces++)
+				return;
+
+			vx = -vx;
+		}
+
+		if ((Y <= YMIN && vy < 0) || (Y >= YMAX && vy > 0))
+		{
+			if (CheckXBasket(X) || bounces++)
+				return;
+
+			vy = -vy;
+		}
+
+		row = VirtualToRealRow(Y);
+		col = X >> 1;
+
+		if (Contact(x, y) != NONE)
+		{
+			if (BallAt(row, col) == NONE)
+			{
+				*grow = row;
+				*gcol = col;
+			}
+
+			return;
+		}
+
+		if (n % DOTGAP == 0 && BallAt(row, col) == NONE &&
+		    !ONPATH(map, row, col))
+		{
+			map[(row << 3) + (col >> 3)] |= bit[col & 7];
+			dotrow[ndots] = row;
+			dotcol[ndots++] = col;
+		}
+	}
+}
+
+// shows the path for the current aim point (on = 1), or erases it
+void ShowPath(char on)
+{
+	unsigned char *old = pathmap[curmap];
+	unsigned char *map = pathmap[curmap ^ 1];
+	unsigned char grow, gcol, orow = ghostrow, ocol = ghostcol;
+	unsigned char i, row, col;
+
+	memset(map, 0, sizeof(pathmap[0]));
+
+	if (on)
+		FollowPath(map, &grow, &gcol);
+	else
+	{
+		ndots = 0;
+		gcol = NONE;
+	}
+
+	curmap ^= 1;		// RestoreCell uses the new path from here
+	ghostrow = grow;
+	ghostcol = gcol;
+
+	// the dots gone (the old path cells are found from the old map)
+	for (row = 1; row < 47; row++)
+		for (col = 0; col < 64; col += 8)
+			if (old[(row << 3) + (col >> 3)])
+				for (i = col; i < col + 8; i++)
+					if (ONPATH(old, row, i) && !ONPATH(map, row, i) &&
+					    !(row == rowCH && i == colCH))
+						RestoreCell(row, i);
+
+	if (ocol != NONE && !(orow == rowCH && ocol == colCH))
+		RestoreCell(orow, ocol);
+
+	// the new dots
+	for (i = 0; i < ndots; i++)
+	{
+		row = dotrow[i];
+		col = dotcol[i];
+
+		if (!ONPATH(old, row, col) && !(row == rowCH && col == colCH))
+			PrintChar(row, col, '.');
+	}
+
+	if (gcol != NONE && !(grow == rowCH && gcol == colCH))
+		PrintChar(grow, gcol, 0x41);
+}
+
 int main(int argc, char** argv)
 {
 	char ch;
+	int i, n = 1;
+
+	// a number (1...15) sets the object balls, anything else the training mode
+	TrainingMode = 0;
+
+	for (i = 1; i < argc; i++)
+		if (isdigit(argv[i][0]))
+			n = atoi(argv[i]);
+		else
+			TrainingMode = 1;
+
+	if (n < 1)
+		n = 1;
+	else if (n > MAXBALLS - 1)
+		n = MAXBALLS - 1;
 
-	TrainingMode = (argc > 1) ? 1 : 0;
+	nballs = n + 1;
 
 	CrtSetup();
 	xrndseed();
 
 	Save_0_to_11();
 	Load_0_to_10(); //load fonts for the white ball
+	InitRows();
 
 	Clear();
 	printf("the little game of pool\r\n\n");
-	printf("your job is to aim (using the crosshair '+') and hit the @ ball\r\n");
+	printf("your job is to aim (using the crosshair '+') and hit the @ ball%s\r\n", n > 1 ? "s" : "");
 	printf(" with the A ball, with an appropriate force, in order\r\n");
-	printf(" to push it into one of the 6 available pockets...\r\n\n");
+	printf(" to push %s into one of the 6 available pockets...\r\n\n", n > 1 ? "them" : "it");
 	printf("the balls will bounce back when hitting the rim,\r\n");
 	printf(" and will collide according to the laws of physics\r\n");
 	printf("also, friction will slow their movement speed\r\n\n");
@@ -1123,39 +1434,29 @@ int main(int argc, char** argv)
 	if (TrainingMode)
 		printf("you are in the training mode...\r\n");
 
+	CalibrateFrames();
+
 	printf("hit any key to start:");
 	CrtIn();
 
 	SetCursor();
 
-	get_balls_coord();	//set balls positions
+	SetBalls();		//set balls positions
 train:
-	X0 = _X0;
-	Y0 = _Y0;
-	X1 = _X1;
-	Y1 = _Y1;
-	x0 = _x0;
-	y0 = _y0;
-	x1 = _x1;
-	y1 = _y1;
+	PlaceBalls();
 
 	show_boundaries();	//clear screen, show boundaries
 
-	PrintChar(VirtualToRealRow(Y0), X0/2, 0x41);
-	PrintChar(VirtualToRealRow(Y1), X1/2, 0x40);
+	ShowBalls();
 again:
-	colX0 = X0 / 2;
-	rowY0 = VirtualToRealRow(Y0);
-	colX1 = X1 / 2;
-	rowY1 = VirtualToRealRow(Y1);
+	SetAim();
 
 	get_cross_coord();	//set crosshair coord
 				//returns XCH, XCHf, YCH, YCHf
+	if (Preview)
+		ShowPath(1);
 
-	moving_ball = WHITE;	
-	collision_exp = 0;	// collision not (yet) detected
-
-	PrintStr(47, 0,"q=quit or aim (s=left,d=right,x=down,e=up) then hit <cr>");
+	PrintStr(47, 0,"q=quit, p=path, aim (s=left,d=right,x=down,e=up) then hit <cr>");
 	
 	ch = CrtIn();
 	
@@ -1164,20 +1465,20 @@ again:
 	
 	do
 	{
-		if (MoveCH(ch))
+		if (ch == 'p')
+		{
+			Preview ^= 1;
+			ShowPath(Preview);
+		}
+		else if (MoveCH(ch))
 			break;
+		else if (Preview && !CrtSts())	// keys waiting: move first
+			ShowPath(1);
 		
 		ch = CrtIn();
 	}
 	while (1);
 
-//	ClearTopLine();
-//	fixedtoa(x1, buftmp1);
-//	fixedtoa(y1, buftmp2);
-//	sprintf(buf, "x1=%s y1=%s ; hit any key...", buftmp1, buftmp2);
-//	PrintStr(47, 0, buf);
-//	CrtIn();
-
 	ClearTopLine();
 	fixedtoa(XCHfp, buftmp1);
 	fixedtoa(YCHfp, buftmp2);
@@ -1197,119 +1498,47 @@ again:
 	while (speed == 0 || speed > 25);
 
 	PrintChar(0,0,REV_BLANK);
-	init_counter = counter = 26 - speed; 	//set up speed control
-	brake_counter = 10;			//set up brake control
 
-	PrintChar(rowCH, colCH, ' ');	//erase crosshairs
+	ShowPath(0);			//erase aim preview
+	RestoreCell(rowCH, colCH);	//erase crosshairs
 
 	angle = ComputeAngle(x0, y0, XCHfp, YCHfp);	//compute initial ball movement angle
 
-recompute:
+	Shoot();
 
-	xstart = x0;
-	ystart = y0;
-
-	//compute distance from the target ball center to the movement vector
-	distance = DistanceTo(X1, Y1, X0, Y0, XCH, XCHf, YCH, YCHf);
-
-	if (distance < 0x1E0)
+	if (left == 0)
 	{
-		collision_exp = 1; //collision expected, compute impact point
-
-		// impacted ball will move along (xp,yp) (X1,Y1) vector
-		// where the speed at collision will be the speed of the moving ball
-		// when aprox distance between balls become < 3
-
-		if (distance < 0x020) //approximate for small distances...
-		{	
-			// keep same angle and speed
-			keep_speed = 1;
-			xp = x0;
-			yp = y0;
-		}
-		else
-		{
-			// compute collision parameters
-			keep_speed = 0;
-
-			xper = Xper(X1, Y1, X0, Y0, XCH, XCHf, YCH, YCHf);
-			yper = Yper(X1, Y1, X0, Y0, XCH, XCHf, YCH, YCHf);
-
-			ddelta = fpsqrt(0x400 - mul(distance, distance));
-
-			xp = xper - mul(ddelta, cos(angle));
-			yp = yper - mul(ddelta, sin(angle));
-
-			alpha = arctan(div(distance, ddelta));	// the angle between the two vectors
-
-			if (angle < ComputeAngle(x0, y0, x1, y1))
-			{
-				new_angle = angle + alpha;
-				if (new_angle > twoPI)
-					new_angle = new_angle - twoPI;
-			}
-			else
-			{
-				new_angle = angle - alpha;
-				if (new_angle < 0)
-					new_angle = twoPI + new_angle;
-			}
+		ClearTopLine();
+		PrintStr(47,0,"well done, all the target balls dropped to pockets! hit any key...");
+		CrtIn();
+		goto quit;
+	}
 
-			// impacted ball initial speed = speed * cos(alpha)
-			// moving at new angle = angle +- alpha
-			// where the speed will be the speed of the moving ball when distance between balls become < 3
-		}
+	if (scratch)
+	{
+		ClearTopLine();
+		PrintStr(47,0,"bad luck, the A ball dropped to a pocket! hit any key...");
+		CrtIn();
+		SpotCue();
+		ShowBalls();
 	}
-	else
+	else if (potted)
 	{
-		// no direct impact, continue moving the ball; 
-		// at first bounce back impact, use impact coord as start coord
-		// with angle being recomputed
-			
-		collision_exp = 0;
+		ClearTopLine();
+		sprintf(buf, "well done, %d target ball%s dropped to pockets! hit any key...", potted, potted > 1 ? "s" : "");
+		PrintStr(47, 0, buf);
+		CrtIn();
 	}
 
-	do
+	if (TrainingMode)
 	{
-		status = move_ball();
-
-		if (status == BOUNCED)
-		{
-			if (moving_ball == WHITE)
-				goto recompute;
-		}
-		else if (status == STOPPED)
-		{
-			Load_0_to_10(); //load fonts for the white ball
-			PrintChar(VirtualToRealRow(Y0), X0/2, 0x41);
-			PrintChar(VirtualToRealRow(Y1), X1/2, 0x40);
-
-			if (TrainingMode)
-			{
-				ClearTopLine();
-				PrintStr(47, 0, "hit any key...");
-				CrtIn();
-				goto train;
-			}
-			else
-				goto again;
-		}
-		else if (status == BASKET)
-		{
-			hide(int_part(xold), int_part(yold));
-
-			ClearTopLine();
-
-			if (moving_ball == BLACK)
-				PrintStr(47,0,"well done, target ball dropped to pocket! hit any key...");
-			else
-				PrintStr(47,0,"bad luck, wrong ball dropped to pocket! hit any key...");
-
-			CrtIn();
-			goto quit;
-		}
+		ClearTopLine();
+		PrintStr(47, 0, "hit any key...");
+		CrtIn();
+		goto train;
 	}
-	while (1);
+
+	goto again;
 quit:
 	Clear();
 	Restore_0_to_11();
@@ -0,0 +1,113 @@
+;
+;	Solver visited set, in the two extra 32K banks of the Z80ALL
+;
+;	Writing 1 or 2 to port 1FH maps a bank at 0000H-7FFFH, 0 maps back
+;	the TPA : this code must be stored above 8000H (psect top)
+;
+;	16K entries of 4 bytes (lock, lock+1, iteration, pushes),
+;	entry n in bank 1 + n/8K, at (n%8K)*4
+;
+BANKPORT	equ	1FH
+
+	psect	top
+
+	global	_TTClear, _TTProbe
+
+;void	TTClear(void)
+
+_TTClear:
+	ld	a,1		;bank 1
+1:
+	ld	c,BANKPORT
+	out	(c),a		;select bank
+	ld	hl,0
+	ld	de,1
+	ld	bc,7FFFH
+	ld	(hl),0
+	ldir			;fill with zeros
+	inc	a
+	cp	3
+	jr	nz,1b
+	xor	a
+	ld	c,BANKPORT
+	out	(c),a		;select 0
+	ret
+
+;char	TTProbe(unsigned short index, unsigned short lock,
+;		unsigned char pushes, unsigned char iter)
+;
+;	returns 1 if the position was already reached in this iteration
+;	with no more pushes, else stores it and returns 0
+
+_TTProbe:
+	ld	hl,2
+	add	hl,sp
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)		;DE=index
+	inc	hl
+	ld	c,(hl)
+	inc	hl
+	ld	b,(hl)		;BC=lock
+	inc	hl
+	ld	a,(hl)		;A=pushes
+	inc	hl
+	inc	hl
+	ld	h,(hl)		;H=iter
+	ld	l,a		;L=pushes
+	push	hl
+	ld	a,d
+	rlca
+	rlca
+	rlca
+	and	1		;A=index bit 13
+	inc	a		;bank 1 or 2
+	push	bc
+	ld	c,BANKPORT
+	out	(c),a		;select bank
+	pop	bc
+	ex	de,hl		;HL=index
+	ld	a,h
+	and	1FH
+	ld	h,a
+	add	hl,hl
+	add	hl,hl		;HL=(index%8K)*4
+	pop	de		;D=iter, E=pushes
+	ld	a,(hl)
+	cp	c
+	jr	nz,store
+	inc	hl
+	ld	a,(hl)
+	cp	b
+	jr	nz,store1
+	inc	hl
+	ld	a,(hl)
+	cp	d
+	jr	nz,store2
+	inc	hl
+	ld	a,e
+	cp	(hl)		;pushes ? stored pushes
+	jr	nc,seen		;not less, already seen
+	ld	(hl),e		;reached with less pushes
+	jr	new
+store:
+	ld	(hl),c
+	inc	hl
+store1:
+	ld	(hl),b
+	inc	hl
+store2:
+	ld	(hl),d
+	inc	hl
+	ld	(hl),e
+new:
+	ld	l,0
+	jr	done
+seen:
+	ld	l,1
+done:
+	xor	a
+	ld	c,BANKPORT
+	out	(c),a		;select 0
+	ret
+;
@@ -25,6 +25,19 @@
 
 //#define Z80ALL
 
+/* uncomment (with Z80ALL) to write straight to the VGA screen, */
+/* else the screen is written through the BIOS                  */
+//#define VGA
+
+#ifdef VGA
+#include "vga.h"
+#undef putchar
+#define putchar(c)	VPutc(c)
+#define printf(s)	VPuts(s)	/* the numbers are formatted by sprintf */
+#else
+#define VSync()				/* the BIOS cursor is already there */
+#endif
+
 /**/
 /* OBJECT: this typedef is used for internal and external representation */
 /*         of objects                                                    */
@@ -69,6 +82,15 @@ typedef struct {
 #define E_USAGE		7
 #define E_LEVELTOOHIGH	8
 #define E_ENDGAME	9
+#define E_FWRITE	10
+
+/* soklevls.rle, built once from soklevls.dat: a 128 bytes header    */
+/* (number of levels, then the byte offset of each level, 16 bit),   */
+/* then the levels, run-length encoded: (count << 3) | char code,   */
+/* count = 1...31, char code = index in rlechars[], 0 = end of level */
+#define RLEHEADER	128
+#define MAXLEVELS	((RLEHEADER - 2) / 2)
+#define MAXRUN		31
 
 /* defining the types of move */
 #define MOVE 		1
@@ -87,15 +109,29 @@ typedef struct {
 #define CNTL_U		'\025'
 
  POS   tpos1,		   /* testpos1: 1 pos. over/under/left/right */
-       tpos2,		   /* testpos2: 2 pos.  "                    */
-       lastppos,	   /* the last player position (for undo)    */
-       last_p1, last_p2; /* last test positions (for undo)         */
- char lppc, ltp1c, ltp2c;    /* the char for the above pos. (for undo) */
- char action, lastaction;
+       tpos2;		   /* testpos2: 2 pos.  "                    */
+ char action;
+
+/** The undo/redo history: one byte per move **/
+#define MAXHIST		8192	/* when full, the oldest half is dropped */
+#define H_DIR		3	/* direction: index in dirkey[]		  */
+#define H_PUSH		4	/* set if a packet was pushed		  */
+
+ char  history[MAXHIST];
+ short histpos,		   /* moves done (next undo: histpos-1)	     */
+       histlen;		   /* moves recorded (redo up to histlen)    */
+
+ char  solvalid;		   /* the solution found leads from here    */
+
+ char  dirkey[] = "kjhl";	   /* up, down, left, right */
+ short dirx[] = { -1, 1, 0, 0 };
+ short diry[] = { 0, 0, -1, 1 };
 
 /** For the temporary save **/
  char  tmp_map[MAXROW+1][MAXCOL+1];
  short tmp_pushes, tmp_moves, tmp_savepack;
+ short tmp_histpos;	   /* -1 if the history no longer leads there */
+ short tmp_deadpos;
  POS   tmp_ppos;
 
 short level, packets, savepack, moves, pushes, rows, cols;
@@ -112,16 +148,29 @@ char *message[] = {
    "too much rows in screen file",
    "too much columns in screenfile",
    "illegal command line syntax",
-   "level number too big in command line"
+   "level number too big in command line",
+   "???",
+   "cannot write level file"
 };
 
+char	rlechars[] = " #$.*@+\n";
+short	rlecount;	/* chars left in the current run */
+char	rlechar;
+
 char	AutoRepeat = 0;
 
+char	line[80];	/* formatted messages */
+
+char	helpline[] = "Use the following keys: arrow keys or ...  ?:hint, !:solve";
+
 #define EOT	4
 #define ESCAPE	0x1B
 
 void domove(short moveaction);
-void undomove(void);
+void recordmove(short moveaction);
+void undomove(char rec);
+void redomove(char rec);
+char hintstep(void);
 void tmpsave(void);
 void tmpreset(void);
 void showscreen(void) ;
@@ -131,19 +180,27 @@ void disppackets(void);
 void dispsave(void);
 void dispmoves(void);
 void disppushes(void);
+void dispdead(void);
 
 void clear()
 {
+#ifdef VGA
+    VClear();
+#else
 #ifdef Z80ALL
     putchar( ESCAPE ); putchar( 'H' );	//home
     putchar( ESCAPE ); putchar( 'J' );	//erase to end-of-screen
 #else
 printf("%c[2J%c[H",27,27);
 #endif
+#endif
 }
 
 void gotoxy(int y,int x)
 {
+#ifdef VGA
+    VLocate(y, x);
+#else
 #ifdef Z80ALL
     putchar( ESCAPE ); putchar( 'Y' );
     putchar( 31+y+1 );
@@ -151,6 +208,20 @@ void gotoxy(int y,int x)
 #else
 printf("%c[%d;%dH",27,y+1,x+1);
 #endif
+#endif
+}
+
+void highlight(char on)
+{
+#ifdef VGA
+    VReverse(on);
+#else
+#ifdef Z80ALL
+    /* no video attributes */
+#else
+printf("%c[%cm",27,on ? '7' : '0');
+#endif
+#endif
 }
 
 int GetKey(void)
@@ -218,32 +289,248 @@ try:
 	return (int)c;
 }
 
+/* write one run of the level file (only count the bytes if out == NULL) */
+short putrun(FILE *out, short count, short c)
+{
+   char *p;
+
+   if( (c == 0) || ((p = strchr( rlechars, c)) == NULL))
+      return( -1);
+   if( out != NULL)
+      putc( (count << 3) | (p - rlechars), out);
+   return( 1);
+}
+
+/* encode soklevls.dat to out, or just compute the offsets if out == NULL */
+/* returns the number of levels, or -1 if an illegal char was found      */
+short encodelevels(FILE *out, unsigned short *offsets)
+{
+   FILE *in;
+   short c, last, count, n;
+   unsigned short off;
+   char inlevel;
+
+   if( (in = fopen( "soklevls.dat", "r")) == NULL)
+      return( 0);
+
+   n = count = last = inlevel = 0;
+   off = RLEHEADER;
+
+   do {
+      c = getc( in);
+      if( (count > 0) && ((c != last) || (count == MAXRUN))) {
+         if( putrun( out, count, last) < 0) {
+            fclose( in);
+            return( -1);
+         }
+         off++;
+         count = 0;
+      }
+      if( (c == 12) || (c == EOF)) {
+	 if( inlevel) {		/* end of level */
+	    if( out != NULL) putc( 0, out);
+	    off++;
+	    n++;
+	    inlevel = 0;
+	 }
+	 if( c == 12) getc( in);	/* get the \n after */
+      }
+      else {
+	 if( ! inlevel) {	/* first char of a level */
+	    if( n == MAXLEVELS) break;
+	    offsets[n] = off;
+	    inlevel = 1;
+	 }
+	 last = c;
+	 count++;
+      }
+   } while( c != EOF);
+
+   fclose( in);
+   return( n);
+}
+
+/* build soklevls.rle from soklevls.dat */
+short buildlevels(void)
+{
+   FILE *out;
+   short n, i;
+   unsigned short offsets[MAXLEVELS];
+
+   if( (n = encodelevels( NULL, offsets)) == 0)
+      return( E_FOPENSCREEN);
+   if( n < 0)
+      return( E_ILLCHAR);
+   if( (out = fopen( "soklevls.rle", "wb")) == NULL)
+      return( E_FWRITE);
+
+   putc( n & 0xFF, out); putc( n >> 8, out);
+   for( i = 0; i < MAXLEVELS; i++) {
+      putc( (i < n) ? offsets[i] & 0xFF : 0, out);
+      putc( (i < n) ? offsets[i] >> 8 : 0, out);
+   }
+   encodelevels( out, offsets);
+
+   if( fclose( out) == EOF)
+      return( E_FWRITE);
+   return( 0);
+}
+
+/* next char of the level, 12 at the end */
+short levelgetc(FILE *screen)
+{
+   short c;
+
+   if( rlecount == 0) {
+      if( ((c = getc( screen)) == 0) || (c == EOF))
+         return( 12);
+      rlecount = (c >> 3) & MAXRUN;
+      rlechar = rlechars[c & 7];
+   }
+   rlecount--;
+   return( rlechar);
+}
+
+/*************************************************************************
+* Deadlocks: dist[] (pushes from each cell to the nearest store, DEAD   *
+* if a packet there can never reach one) is set once per level by      *
+* readscreen(). After each push only the pushed packet and the packets *
+* around it are looked at, so the check costs nothing visible           *
+*************************************************************************/
+#define MAXCELL		((MAXROW+1)*(MAXCOL+1))
+#define W		(MAXCOL+1)	/* cell = row * W + col */
+#define DEAD		255
+
+ char  *sm = &map[0][0];
+ short doff[4] = { -W, W, -1, 1 };	/* same order as dirkey[] */
+ unsigned char dist[MAXCELL];	/* pushes from the cell to a store, or DEAD */
+ short queue[MAXCELL];
+ char  offgoal;			/* a frozen packet is not on a store */
+ short deadpos;			/* history position where the level became */
+				/* unsolvable, -1 = still solvable         */
+
+char isstore(char c)
+{
+   return( (c == store.obj_intern) || (c == playerstore.obj_intern) ||
+	   (c == save.obj_intern));
+}
+
+char iswall(char c)
+{
+   return( (c == wall.obj_intern) || (c == '\0'));
+}
+
+char isfree(char c)
+{
+   return( (c == ground.obj_intern) || (c == store.obj_intern));
+}
+
+char isbox(char c)
+{
+   return( (c == packet.obj_intern) || (c == save.obj_intern));
+}
+
+/* dist[] = pushes needed to bring a packet from the cell to the nearest */
+/* store, ignoring the other packets (pulling packets back from stores) */
+void deadsquares(void)
+{
+   short head, tail, p, q, d;
+
+   memset( dist, DEAD, MAXCELL);
+   head = tail = 0;
+   for( p = 0; p < rows * W; p++)
+      if( isstore( sm[p])) {
+         dist[p] = 0;
+         queue[tail++] = p;
+      }
+   while( head < tail) {
+      p = queue[head++];
+      for( d = 0; d < 4; d++) {
+         q = p + doff[d];
+	 if( (dist[q] == DEAD) && ! iswall( sm[q]) && ! iswall( sm[q + doff[d]])) {
+	    dist[q] = dist[p] + 1;
+	    queue[tail++] = q;
+	 }
+      }
+   }
+}
+
+char isfrozen(short c);
+
+/* TRUE if the packet at c cannot move along the axis o (1 or W) */
+char axisblocked(short c, short o)
+{
+   if( iswall( sm[c - o]) || iswall( sm[c + o]))
+      return( 1);
+   if( (dist[c - o] == DEAD) && (dist[c + o] == DEAD))
+      return( 1);
+   if( isbox( sm[c - o]) && isfrozen( c - o))
+      return( 1);
+   if( isbox( sm[c + o]) && isfrozen( c + o))
+      return( 1);
+   return( 0);
+}
+
+/* TRUE if the packet at c can never move again (offgoal is set if it */
+/* or a packet blocking it is not on a store)                         */
+char isfrozen(short c)
+{
+   char save_c, f;
+
+   save_c = sm[c];
+   sm[c] = wall.obj_intern;	/* no loops between packets */
+   f = axisblocked( c, 1) && axisblocked( c, W);
+   sm[c] = save_c;
+   if( f && (save_c == packet.obj_intern)) offgoal = 1;
+   return( f);
+}
+
+/* TRUE if the packet just pushed to c makes the level unsolvable: it */
+/* is on a dead square, or it froze itself or others off the stores   */
+char deadlocked(short c)
+{
+   if( (sm[c] == packet.obj_intern) && (dist[c] == DEAD))
+      return( 1);
+   offgoal = 0;
+   return( isfrozen( c) && offgoal);
+}
+
 short readscreen(void)
 {
    FILE *screen;
    short j, c, f, ret = 0;
+   unsigned short off;
 
-   if( (screen = fopen( "soklevls.dat", "r")) == NULL)
-      ret = E_FOPENSCREEN;
-   else
+   if( (screen = fopen( "soklevls.rle", "rb")) == NULL) {
+      printf( "Building soklevls.rle...");
+      if( (ret = buildlevels()) == 0)
+         if( (screen = fopen( "soklevls.rle", "rb")) == NULL)
+            ret = E_FOPENSCREEN;
+   }
+   if( ret == 0)
    {
-      if(level>1) 
+      /* find the level offset in the header, then seek to it */
+      c = getc( screen); c |= getc( screen) << 8;
+      if( level > c)
       {
-         for(f=1;f<level;f++) 
-         {
-            while((c=getc(screen))!=12 && c!=EOF) ;
-	    if (c == EOF)
-	    {
-		printf(message[E_LEVELTOOHIGH]);
-		exit(0);
-	    }
-            getc(screen);	/* get the \n after */
-         }
+	 printf(message[E_LEVELTOOHIGH]);
+	 VSync();
+	 exit(0);
       }
+      for(f=1;f<level;f++) 
+      {
+         getc(screen); getc(screen);
+      }
+      off = getc( screen); off |= getc( screen) << 8;
+      fseek( screen, (long)off, 0);
+      rlecount = 0;
 
+      memset( map, 0, sizeof( map));	/* no cells left from the last level */
       packets = savepack = rows = j = cols  = 0;
+      histpos = histlen = 0;
+      tmp_histpos = -1;
       ppos.x = -1; ppos.y = -1;
-      while( (ret == 0) && ((c = getc( screen)) != 12) && c!=EOF) {
+      while( (ret == 0) && ((c = levelgetc( screen)) != 12)) {
          if( c == '\n') {
 	    map[rows++][j] = '\0';
 	    if( rows > MAXROW) 
@@ -275,6 +562,10 @@ short readscreen(void)
       fclose( screen);
       if( (ret == 0) && (ppos.x == -1)) ret = E_PLAYPOS2;
    }
+   if( ret == 0) {
+      deadsquares();
+      deadpos = -1;
+   }
    return( ret);
 }
 
@@ -319,7 +610,6 @@ short play(void)
 {
    short c;
    short ret;
-   short undolock = 1;		/* locked for undo */
 
    showscreen();
    tmpsave();
@@ -333,6 +623,9 @@ short play(void)
 		  case '6': c = 'l'; break;
                   default: break; };
 
+      if( (c != '?') && (c != '!'))
+         solvalid = 0;		/* the solution found may not apply */
+
       switch(c) {
 	 case 'q': /* quit the game 					*/
 	              ret = E_ENDGAME; 
@@ -344,21 +637,28 @@ short play(void)
 	  
          case 'r':	/* reset to temporary save 			*/
 		      tmpreset();
-		      undolock = 1;
 		      showscreen();
 		      break;
 	 case 'U':    /* undo this level 				*/
 		      moves = pushes = 0;
 		      if( (ret = readscreen()) == 0) {
 		         showscreen();
-			 undolock = 1;
 		      }
 		      break;
 	 case 'u':    /* undo last move 				*/
-		      if( ! undolock) {
-		         undomove();
-		         undolock = 1;
-		      }
+		      if( histpos > 0)
+		         undomove( history[--histpos]);
+		      break;
+	 case CNTL_R: /* redo the move undone last			*/
+		      if( histpos < histlen)
+		         redomove( history[histpos++]);
+		      break;
+	 case '?':    /* hint: one move towards the solution		*/
+		      hintstep();
+		      break;
+	 case '!':    /* play the solution				*/
+		      while( (packets != savepack) && hintstep())
+		         ;
 		      break;
 
     	 case 'k':    /* up 						*/
@@ -375,15 +675,8 @@ short play(void)
 	 case CNTL_H: /* run left, stop before object 			*/
 		      do {
 		         if( (action = testmove( c)) != 0) {
-			    lastaction = action;
-		            lastppos.x = ppos.x; lastppos.y = ppos.y;
-		            lppc = map[ppos.x][ppos.y];
-		            last_p1.x = tpos1.x; last_p1.y = tpos1.y; 
-		            ltp1c = map[tpos1.x][tpos1.y];
-		            last_p2.x = tpos2.x; last_p2.y = tpos2.y; 
-		            ltp2c = map[tpos2.x][tpos2.y];
-		            domove( lastaction); 
-		            undolock = 0;
+		            recordmove( action);
+		            domove( action); 
 		         }
 		      } while( (action != 0) && (! islower( c))
 			      && (packets != savepack));
@@ -427,28 +720,93 @@ void domove(short moveaction)
    gotoxy( MAXROW+1, 0);
    
    ppos.x = tpos1.x; ppos.y = tpos1.y;
+
+   if( (deadpos == -1) && (moveaction != MOVE) && (moveaction != STOREMOVE)
+       && deadlocked( tpos2.x * W + tpos2.y)) {
+      deadpos = histpos;
+      dispdead();
+   }
 }
 
-void undomove(void) 
+/* store the move about to be done (before domove) in the history */
+void recordmove(short moveaction)
 {
-   map[lastppos.x][lastppos.y] = lppc;
-   map[last_p1.x][last_p1.y] = ltp1c;
-   map[last_p2.x][last_p2.y] = ltp2c;
-   ppos.x = lastppos.x; ppos.y = lastppos.y;
-   switch( lastaction) {
-      case MOVE:      moves--;				break;
-      case STOREMOVE: moves--;				break;
-      case PUSH:      moves--; pushes--;		break;
-      case UNSAVE:    moves--; pushes--; savepack++;	break;
-      case SAVE:      moves--; pushes--; savepack--;	break;
-      case STOREPUSH: moves--; pushes--;		break;
+   char rec;
+   short i;
+
+   if( tpos1.x < ppos.x)      rec = 0;
+   else if( tpos1.x > ppos.x) rec = 1;
+   else if( tpos1.y < ppos.y) rec = 2;
+   else                       rec = 3;
+
+   if( (moveaction != MOVE) && (moveaction != STOREMOVE))
+      rec |= H_PUSH;
+
+   if( histpos == MAXHIST) {	/* full, drop the oldest half */
+      for( i = 0; i < MAXHIST/2; i++)
+         history[i] = history[i + MAXHIST/2];
+      histpos = MAXHIST/2;
+      tmp_histpos = (tmp_histpos >= MAXHIST/2) ? tmp_histpos - MAXHIST/2 : -1;
+      if( deadpos != -1)	/* 0 if it can no longer be undone */
+         deadpos = (deadpos >= MAXHIST/2) ? deadpos - MAXHIST/2 : 0;
    }
+
+   if( histpos < tmp_histpos)	/* leaving the path to the saved position */
+      tmp_histpos = -1;
+
+   history[histpos++] = rec;
+   histlen = histpos;		/* a new move ends the redo list */
+}
+
+/* take back a move read from the history: the player steps back, */
+/* pulling the packet along if the move was a push                */
+void undomove(char rec) 
+{
+   POS p0, p2;
+
+   p0.x = ppos.x - dirx[rec & H_DIR]; p0.y = ppos.y - diry[rec & H_DIR];
+   p2.x = ppos.x + dirx[rec & H_DIR]; p2.y = ppos.y + diry[rec & H_DIR];
+
+   map[p0.x][p0.y] = isstore( map[p0.x][p0.y]) 
+			 ? playerstore.obj_intern 
+			 : player.obj_intern;
+   if( rec & H_PUSH) {
+      if( map[p2.x][p2.y] == save.obj_intern) savepack--;
+      map[p2.x][p2.y] = isstore( map[p2.x][p2.y]) 
+			    ? store.obj_intern 
+			    : ground.obj_intern;
+      if( isstore( map[ppos.x][ppos.y])) {
+         map[ppos.x][ppos.y] = save.obj_intern;
+         savepack++;
+      }
+      else
+         map[ppos.x][ppos.y] = packet.obj_intern;
+      pushes--;
+   }
+   else
+      map[ppos.x][ppos.y] = isstore( map[ppos.x][ppos.y]) 
+			       ? store.obj_intern 
+			       : ground.obj_intern;
+   moves--;
    dispmoves(); disppushes(); dispsave();
+   mapchar( map[p0.x][p0.y], p0.x, p0.y);
    mapchar( map[ppos.x][ppos.y], ppos.x, ppos.y);
-   mapchar( map[last_p1.x][last_p1.y], last_p1.x, last_p1.y);
-   mapchar( map[last_p2.x][last_p2.y], last_p2.x, last_p2.y);
+   if( rec & H_PUSH)
+      mapchar( map[p2.x][p2.y], p2.x, p2.y);
    gotoxy( MAXROW+1, 0);
-   
+
+   ppos.x = p0.x; ppos.y = p0.y;
+
+   if( histpos < deadpos) {	/* back before the fatal push */
+      deadpos = -1;
+      dispdead();
+   }
+}
+
+/* do again a move read from the history */
+void redomove(char rec)
+{
+   domove( testmove( dirkey[rec & H_DIR]));
 }
 
 void tmpsave(void) 
@@ -461,6 +819,8 @@ void tmpsave(void)
    tmp_moves = moves;
    tmp_savepack = savepack;
    tmp_ppos.x = ppos.x; tmp_ppos.y = ppos.y;
+   tmp_histpos = histpos;
+   tmp_deadpos = deadpos;
 }
 
 void tmpreset(void)
@@ -473,6 +833,491 @@ void tmpreset(void)
    moves = tmp_moves;
    savepack = tmp_savepack;
    ppos.x = tmp_ppos.x; ppos.y = tmp_ppos.y;
+   if( tmp_histpos < 0) {
+      histpos = histlen = 0;
+      deadpos = (tmp_deadpos == -1) ? -1 : 0;
+   }
+   else {
+      histpos = tmp_histpos;
+      deadpos = tmp_deadpos;
+   }
+}
+
+/*************************************************************************
+* Solver: IDA* on pushes, over the map itself (the player is lifted out  *
+* of the map while searching). The lower bound is the least total of     *
+* pushes taking each packet to a store of its own (a minimum matching    *
+* of packets to stores, kept up to date by one step of the Hungarian     *
+* method after each push); a position with no such matching is dead.     *
+* Dead squares (where a packet can never reach a store) are never        *
+* pushed to, frozen packets off a store cut the search and positions     *
+* already reached with no more pushes in the same iteration are          *
+* skipped, through a hashed visited set (in the two extra 32K banks on   *
+* Z80ALL, else as large as the free memory allows)                       *
+*************************************************************************/
+#define MAXPUSH		250		/* max solution length (pushes) */
+#define NOBOUND		32767
+#define PSTACK		2000		/* pushes waiting to be tried    */
+#define MAXBOX		40		/* packets the solver can handle */
+#define MAXSDIST	4096		/* stores * live cells           */
+#define NOBOX		255
+
+#ifdef Z80ALL
+#define TTSIZE		16384		/* 4 bytes each, in the 2 banks */
+char TTProbe(unsigned short index, unsigned short lock,
+	     unsigned char pushes, unsigned char iter);
+void TTClear(void);
+#else
+#define TTMAX		8192		/* entries, if the memory is there */
+#define STACKROOM	8192		/* bytes kept for the search stack */
+struct ttentry {
+   unsigned short lock;
+   unsigned char iter, pushes;
+} *tt;
+#endif
+
+ unsigned char reach[MAXCELL];	/* == stamp if marked by flood/walkdir */
+ unsigned char stamp;
+ short qlen;
+ unsigned short zhash[MAXCELL], zlock[MAXCELL], hash, lock;
+ unsigned short ttsize;		/* visited set entries, a power of 2 */
+ short pstack[PSTACK], psp;	/* pushes as cell*4+dir */
+ short sol[MAXPUSH], nsol, solnext;	/* solution pushes, next one */
+ short spl;			/* player cell while searching */
+ short bound, nextbound;
+ unsigned char iter;
+ char  ttinit;
+ char  aborted;			/* 1 = key hit, 2 = out of memory, 3 = too long */
+ unsigned short nodes;
+
+ short nbox, nstore, nlive;
+ short bcell[MAXBOX];		/* cell of each packet */
+ unsigned char bat[MAXCELL];	/* packet at the cell, if isbox() */
+ unsigned char live[MAXCELL];	/* index of a cell with dist != DEAD */
+ unsigned char sdist[MAXSDIST];	/* [store * nlive + live[cell]] pushes */
+				/* from the cell to that store, or DEAD */
+ short u[MAXBOX+1], v[MAXBOX+1];	/* Hungarian method: packet and store */
+ short minv[MAXBOX+1];			/* potentials, column 0 is a dummy    */
+ unsigned char sbox[MAXBOX+1];	/* packet matched to store j-1, or NOBOX */
+ unsigned char way[MAXBOX+1], used[MAXBOX+1];
+
+#ifndef Z80ALL
+/* returns 1 if the position was already reached in this iteration with */
+/* no more pushes, else stores it and returns 0                         */
+char TTProbe(unsigned short index, unsigned short lock,
+	     unsigned char pushes, unsigned char iter)
+{
+   if( (tt[index].lock == lock) && (tt[index].iter == iter) &&
+       (tt[index].pushes <= pushes))
+      return( 1);
+   tt[index].lock = lock;
+   tt[index].iter = iter;
+   tt[index].pushes = pushes;
+   return( 0);
+}
+
+/* the first time, takes the largest table leaving STACKROOM free */
+void TTClear(void)
+{
+   char here;
+
+   if( tt == NULL)
+      for( ttsize = TTMAX; ttsize; ttsize >>= 1)
+	 if( (tt = malloc( ttsize * sizeof( struct ttentry))) != NULL) {
+	    if( (char *)(tt + ttsize) + STACKROOM < &here)
+	       break;
+	    free( tt);
+	    tt = NULL;
+	 }
+   if( tt != NULL)
+      memset( tt, 0, ttsize * sizeof( struct ttentry));
+}
+#endif
+
+void newstamp(void)
+{
+   if( ++stamp == 0) {
+      memset( reach, 0, MAXCELL);
+      stamp = 1;
+   }
+}
+
+/* mark the cells the player can reach from spl in queue[0...qlen-1] */
+/* returns the lowest one (the player position, as hashed)           */
+short flood(void)
+{
+   short head, p, q, d, low;
+
+   newstamp();
+   queue[0] = low = spl;
+   reach[spl] = stamp;
+   head = 0; qlen = 1;
+   while( head < qlen) {
+      p = queue[head++];
+      if( p < low) low = p;
+      for( d = 0; d < 4; d++) {
+         q = p + doff[d];
+	 if( (reach[q] != stamp) && isfree( sm[q])) {
+	    reach[q] = stamp;
+	    queue[qlen++] = q;
+	 }
+      }
+   }
+   return( low);
+}
+
+/* sdist[] for each store, pulling a packet back from it as deadsquares() */
+/* does for all of them; returns 0 if the level is too big for sdist[]    */
+char storedists(void)
+{
+   short head, tail, p, q, d, s;
+   unsigned char *sd;
+
+   nlive = 0;
+   for( p = 0; p < rows * W; p++)
+      if( dist[p] != DEAD)
+	 live[p] = nlive++;
+   nstore = 0;
+   for( s = 0; s < rows * W; s++)
+      if( isstore( sm[s]))
+	 nstore++;
+   if( (nstore > MAXBOX) || (nstore * nlive > MAXSDIST))
+      return( 0);
+   sd = sdist;
+   for( s = 0; s < rows * W; s++)
+      if( isstore( sm[s])) {
+	 memset( sd, DEAD, nlive);
+	 newstamp();
+	 reach[s] = stamp;
+	 sd[live[s]] = 0;
+	 queue[0] = s;
+	 head = 0; tail = 1;
+	 while( head < tail) {
+	    p = queue[head++];
+	    for( d = 0; d < 4; d++) {
+	       q = p + doff[d];
+	       if( (reach[q] != stamp) && ! iswall( sm[q]) &&
+		   ! iswall( sm[q + doff[d]])) {
+		  reach[q] = stamp;
+		  sd[live[q]] = sd[live[p]] + 1;
+		  queue[tail++] = q;
+	       }
+	    }
+	 }
+	 sd += nlive;
+      }
+   return( 1);
+}
+
+/* match the unmatched packet i (Hungarian method, one augmenting path) */
+/* returns 0 if it cannot get a store; the potentials stay valid then   */
+char augment(short i)
+{
+   short j, j0, j1, delta, c;
+   unsigned char *sd;
+
+   for( j = 0; j <= nstore; j++) {
+      minv[j] = NOBOUND;
+      used[j] = 0;
+   }
+   v[0] = 0;
+   sbox[0] = i;
+   j0 = 0;
+   do {
+      used[j0] = 1;
+      i = sbox[j0];
+      sd = &sdist[live[bcell[i]]];
+      delta = NOBOUND;
+      j1 = 0;
+      for( j = 1; j <= nstore; j++, sd += nlive)
+	 if( ! used[j]) {
+	    if( (*sd != DEAD) && ((c = *sd - u[i] - v[j]) < minv[j])) {
+	       minv[j] = c;
+	       way[j] = j0;
+	    }
+	    if( minv[j] < delta) {
+	       delta = minv[j];
+	       j1 = j;
+	    }
+	 }
+      if( delta == NOBOUND)
+	 return( 0);
+      for( j = 0; j <= nstore; j++)
+	 if( used[j]) {
+	    u[sbox[j]] += delta;
+	    v[j] -= delta;
+	 }
+	 else if( minv[j] != NOBOUND)
+	    minv[j] -= delta;
+      j0 = j1;
+   } while( sbox[j0] != NOBOX);
+   do {
+      j1 = way[j0];
+      sbox[j0] = sbox[j1];
+      j0 = j1;
+   } while( j0);
+   return( 1);
+}
+
+/* packet i moved: match it again, returns the new lower bound (the */
+/* pushes of the matching) or NOBOUND if there is no matching        */
+short rematch(short i)
+{
+   short j, c, h;
+   unsigned char *sd;
+
+   u[i] = NOBOUND;
+   sd = &sdist[live[bcell[i]]];
+   for( j = 1; j <= nstore; j++, sd += nlive) {
+      if( sbox[j] == i)
+	 sbox[j] = NOBOX;
+      if( (*sd != DEAD) && ((c = *sd - v[j]) < u[i]))
+	 u[i] = c;
+   }
+   if( ! augment( i))
+      return( NOBOUND);
+   c = v[1];			/* keep the potentials small */
+   for( i = 0; i < nbox; i++)
+      u[i] += c;
+   h = 0;
+   for( j = 1; j <= nstore; j++) {
+      v[j] -= c;
+      if( sbox[j] != NOBOX)
+	 h += sdist[(j-1) * nlive + live[bcell[sbox[j]]]];
+   }
+   return( h);
+}
+
+/* move a packet from b to t while searching, returns the new bound */
+short pushbox(short b, short t)
+{
+   sm[t] = (sm[t] == store.obj_intern) ? save.obj_intern : packet.obj_intern;
+   sm[b] = (sm[b] == save.obj_intern) ? store.obj_intern : ground.obj_intern;
+   hash ^= zhash[b] ^ zhash[t];
+   lock ^= zlock[b] ^ zlock[t];
+   bat[t] = bat[b];
+   bcell[bat[t]] = t;
+   return( rematch( bat[t]));
+}
+
+/* returns 1 = solved (sol[0...g-1] holds the pushes), 0 = not below */
+/* bound, -1 = aborted                                               */
+char search(short g, short h)
+{
+   short start, end, i, p, b, t, d, low;
+   char r;
+
+   if( h == 0) {
+      nsol = g;
+      return( 1);
+   }
+   if( g + h > bound) {
+      if( g + h < nextbound) nextbound = g + h;
+      return( 0);
+   }
+   if( (++nodes & 63) == 0 && kbhit()) {
+      getch();
+      aborted = 1;
+      return( -1);
+   }
+
+   low = flood();
+   if( TTProbe( (hash ^ zlock[low]) & (ttsize-1), lock ^ zhash[low], g, iter))
+      return( 0);
+
+   /* player at p, packet at b, pushed to t */
+   start = psp;
+   for( i = 0; i < qlen; i++) {
+      p = queue[i];
+      for( d = 0; d < 4; d++) {
+         b = p + doff[d];
+	 t = b + doff[d];
+	 if( isbox( sm[b]) && isfree( sm[t]) && (dist[t] != DEAD)) {
+	    if( psp == PSTACK) {
+	       psp = start;
+	       aborted = 2;
+	       return( -1);
+	    }
+	    pstack[psp++] = b * 4 + d;
+	 }
+      }
+   }
+   end = psp;
+
+   r = 0;
+   for( i = start; (i < end) && (r == 0); i++) {
+      b = pstack[i] >> 2; d = pstack[i] & 3;
+      t = b + doff[d];
+      h = pushbox( b, t);
+      p = spl; spl = b;
+      offgoal = 0;
+      if( (h != NOBOUND) && (! isfrozen( t) || ! offgoal)) {
+	 sol[g] = pstack[i];
+	 r = search( g + 1, h);
+      }
+      spl = p;
+      pushbox( t, b);
+   }
+   psp = start;
+   return( r);
+}
+
+/* find the pushes solving the level from the current position */
+/* returns 1 = found, 0 = no solution, -1 = aborted             */
+char solve(void)
+{
+   short p, h;
+   char r, c;
+
+   aborted = 0;
+   nodes = 0;
+   psp = 0;
+   if( ! ttinit) {
+      for( p = 0; p < MAXCELL; p++) {
+         zhash[p] = rand() ^ (rand() << 8);
+         zlock[p] = rand() ^ (rand() << 8);
+      }
+#ifdef Z80ALL
+      ttsize = TTSIZE;
+#endif
+      TTClear();
+      ttinit = 1;
+   }
+#ifndef Z80ALL
+   if( tt == NULL) {
+      aborted = 2;
+      return( -1);
+   }
+#endif
+   if( (packets > MAXBOX) || ! storedists()) {
+      aborted = 2;
+      return( -1);
+   }
+
+   spl = ppos.x * W + ppos.y;
+   c = sm[spl];			/* lift the player */
+   sm[spl] = (c == playerstore.obj_intern) ? store.obj_intern : ground.obj_intern;
+
+   hash = lock = 0;
+   r = -3;
+   nbox = 0;
+   for( p = 0; p < rows * W; p++)
+      if( isbox( sm[p])) {
+         if( dist[p] == DEAD) r = 0;	/* already lost */
+	 bat[p] = nbox;
+	 bcell[nbox++] = p;
+	 hash ^= zhash[p];
+	 lock ^= zlock[p];
+      }
+   h = 0;
+   if( r == -3) {
+      memset( sbox, NOBOX, sizeof( sbox));
+      memset( v, 0, sizeof( v));
+      for( p = 0; (p < nbox) && (h != NOBOUND); p++)
+	 h = rematch( p);
+      if( h == NOBOUND)
+	 r = 0;			/* some packets cannot all get a store */
+   }
+
+   bound = h;
+   while( r == -3) {
+      if( ++iter == 0) {
+         TTClear();
+	 iter = 1;
+      }
+      nextbound = NOBOUND;
+      r = search( 0, h);
+      if( r == 0) {
+         if( nextbound == NOBOUND)
+	    break;		/* no solution */
+	 if( nextbound > MAXPUSH) {
+	    aborted = 3;
+	    r = -1;
+	    break;
+	 }
+	 bound = nextbound;
+	 r = -3;
+      }
+   }
+
+   sm[spl] = c;
+   return( r);
+}
+
+/* direction of the first step of a shortest walk of the player to the */
+/* cell to, -1 if it cannot get there                                  */
+short walkdir(short to)
+{
+   short head, tail, p, q, d, pl;
+
+   pl = ppos.x * W + ppos.y;
+   newstamp();
+   queue[0] = to;
+   reach[to] = stamp;
+   head = 0; tail = 1;
+   while( head < tail) {
+      p = queue[head++];
+      for( d = 0; d < 4; d++) {
+         q = p + doff[d];
+	 if( q == pl)
+	    return( d ^ 1);	/* the player steps back from q to p */
+	 if( (reach[q] != stamp) && isfree( sm[q])) {
+	    reach[q] = stamp;
+	    queue[tail++] = q;
+	 }
+      }
+   }
+   return( -1);
+}
+
+void dispmsg(char *s)
+{
+   gotoxy( MAXROW+1, 0);
+   sprintf( line, "%-44s", s);
+   printf( line);
+   gotoxy( MAXROW+1, 0);
+}
+
+/* do one move along the solution, solving first if needed */
+/* returns 0 if there is no move to do                     */
+char hintstep(void)
+{
+   short b, d, pl;
+   char r;
+
+   if( ! solvalid) {
+      dispmsg( "Solving... (any key to stop)");
+      if( (r = solve()) != 1) {
+         if( r == 0)
+	    dispmsg( "No solution from here: undo some moves!");
+	 else
+	    dispmsg( (aborted == 1) ? "Stopped." :
+		     (aborted == 2) ? "Out of memory, sorry..." :
+				      "Too many pushes left, sorry...");
+	 return( 0);
+      }
+      solvalid = 1;
+      solnext = 0;
+      gotoxy( MAXROW+1, 0);
+      sprintf( line, "Solved in %d pushes                          ", nsol);
+      printf( line);
+   }
+   if( solnext == nsol)
+      return( 0);
+
+   b = sol[solnext] >> 2; d = sol[solnext] & 3;
+   pl = ppos.x * W + ppos.y;
+   if( pl == b - doff[d])
+      solnext++;		/* push */
+   else if( (d = walkdir( b - doff[d])) < 0) {	/* walk to the packet */
+      solvalid = 0;		/* no way there: the solution is stale */
+      return( 0);
+   }
+
+   action = testmove( dirkey[d]);
+   recordmove( action);
+   domove( action);
+   return( 1);
 }
 
 void showscreen(void) 
@@ -491,9 +1336,12 @@ void showscreen(void)
    dispmoves();
    disppushes();
    gotoxy(MAXROW+1,0);
-   printf("Use the following keys: arrow keys or ...\r\n");
+   printf( helpline);
+   printf( "\r\n");
    printf(" 8/k/up, 2/j/down, 4/h/left, 6/l/right to move/push\r\n");
-   printf(" q:quit, u:undo last move, U:undo all, s:save, r:restore");
+   printf(" q:quit, u:undo, ^R:redo, U:undo all, s:save, r:restore");
+   if( deadpos != -1)
+      dispdead();
    gotoxy( MAXROW+1,0);
 }
 
@@ -506,7 +1354,8 @@ void mapchar(char c, short i, short j)
    obj = get_obj_adr( c);
 
    gotoxy( i + offset_row, 2*j + offset_col); 
-   printf( "%c%c", obj ->obj_display1, obj ->obj_display2);
+   putchar( obj ->obj_display1);
+   putchar( obj ->obj_display2);
 }
 
 OBJECT *get_obj_adr(char c)
@@ -527,27 +1376,46 @@ OBJECT *get_obj_adr(char c)
 
 void displevel(void) 
 { 
-   gotoxy( MAXROW, 7); printf( "%3d", level); 
+   gotoxy( MAXROW, 7); sprintf( line, "%3d", level); printf( line);
 }
    
 void disppackets(void) 
 { 
-   gotoxy( MAXROW, 21); printf( "%3d", packets); 
+   gotoxy( MAXROW, 21); sprintf( line, "%3d", packets); printf( line);
 }
    
 void dispsave(void) 
 { 
-   gotoxy( MAXROW, 33); printf( "%3d", savepack); 
+   gotoxy( MAXROW, 33); sprintf( line, "%3d", savepack); printf( line);
 }
    
 void dispmoves(void) 
 { 
-   gotoxy( MAXROW, 43); printf( "%4d", moves); 
+   gotoxy( MAXROW, 43); sprintf( line, "%4d", moves); printf( line);
 }
       
 void disppushes(void) 
 { 
-   gotoxy( MAXROW, 57); printf( "%4d", pushes); 
+   gotoxy( MAXROW, 57); sprintf( line, "%4d", pushes); printf( line);
+}
+
+/* the deadlock warning, or the help line back once it is undone */
+void dispdead(void)
+{
+   gotoxy( MAXROW+1, 0);
+   if( deadpos != -1) {
+      putchar( 7);
+      highlight( 1);
+      sprintf( line, "%-58s", "DEADLOCK! This level cannot be solved now: u to undo");
+      printf( line);
+      highlight( 0);
+   }
+   else
+   {
+      sprintf( line, "%-58s", helpline);
+      printf( line);
+   }
+   gotoxy( MAXROW+1, 0);
 }
 
 void gameloop(void) {
@@ -582,6 +1450,7 @@ void main( int argc, char** argv)
       if (!(optlevel = atoi(argv[1])))
       {
          printf(message[E_USAGE]);
+	 VSync();
 	 exit(1);
       }
    }
@@ -597,5 +1466,6 @@ void main( int argc, char** argv)
    level=optlevel;
 
    gameloop();
+   VSync();
 }
 
@@ -1,9 +1,15 @@
 ;
 ;	Save & Load games
 ;
-	global	_grid, _grid_nr, _LoadGame, _SaveGame
+;	All games are kept in SUDOKU.SAV, 2 packed games (64 bytes each)
+;	per 128 bytes record : game n is in record n/2, at offset (n%2)*64
+;	Loading is a single random record read,
+;	saving a random record read + write (keeps the other game)
+;
+	global	_packed, _LoadGame, _SaveGame
 ;
 BDOS	equ	5
+SLOT	equ	64		; packed game size
 
 	MACRO	EXIT
 	jp	0
@@ -13,15 +19,16 @@ BDOS	equ	5
 
 fcb:				; fcb
 	defb	0		; disk+1
-fname:	defm	"SUDOKU  SV "   ; file name
-	defb	0		; EX=0
+fname:	defm	"SUDOKU  SAV"   ; file name
+fcbex:	defb	0		; EX=0
 	defb	0,0		; S1,S2
 	defb	0		; RC=0
 	defb	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0	; D0,...D15
 fcbcr:	defb	0		; CR=0
-	defb	0,0,0		; R0,R1,R2
+fcbr0:	defb	0,0,0		; R0,R1,R2
 ;
 buf:	defs	128
+slot:	defs	2		; address of the game in buf
 ;
 CannotWrite:defb	13,10
 	defm	' Could not write!$'
@@ -42,8 +49,9 @@ show_string_de:
         ld 	c,9
         jp 	BDOS
 ;
-_LoadGame:
-loadgame:
+;	Ask the game number, set the random record # and the slot address
+;
+askgame:
 	ld	de,GameNrMsg	; Ask 'game nr'
 	call	show_string_de
 
@@ -55,12 +63,25 @@ loadgame:
 1:
 	ld	de,WrongNumber
 	call	show_string_de
-	jr	loadgame
+	jr	askgame
 2:
 	cp	'9'+1
 	jr	nc,1b
 
-	ld	(fname+10),a	; Store game # as final ext char
+	sub	'0'
+	ld	hl,buf
+	srl	a		; record = game / 2
+	jr	nc,1f
+	ld	de,SLOT		; odd game, second half
+	add	hl,de
+1:
+	ld	(slot),hl
+	ld	(fcbr0),a
+	xor	a
+	ld	(fcbr0+1),a
+	ld	(fcbr0+2),a
+	ld	(fcbex),a	; prepare fcb
+	ld	(fcbcr),a
 
 	ld	c,2
 	ld	e,0DH
@@ -69,25 +90,25 @@ loadgame:
 	ld	e,0AH
 	call	BDOS
 
+	ld	de,buf		; set DMA addr
+	ld	c,26
+	jp	BDOS
+;
+_LoadGame:
+	call	askgame
+
 	ld	de,fcb		; open file
 	ld	c,15
 	call	BDOS
 	inc	a
 	jr	nz,1f
-
-	ld	de,CannotOpen	; file not found
+2:
+	ld	de,CannotOpen	; file or game not found
 	call	show_string_de
 	EXIT
 1:
-	xor	a		; prepare fcb
-	ld	(fcbcr),a
-
-	ld	de,buf		; set DMA addr
-	ld	c,26
-	call	BDOS
-
-	ld	de,fcb		; read record		
-	ld	c,20
+	ld	de,fcb		; read record
+	ld	c,33
 	call	BDOS
 	or	a
 	jr	z,1f
@@ -99,86 +120,59 @@ loadgame:
 	ld	de,fcb		; close file
 	ld	c,16
 	call	BDOS
-				;load data
-	ld	de,_grid
-	ld	hl,buf
-	ld	c,81		;9x9
-1:
-	ld	a,(hl)
-	ld	(de),a
-	inc	hl
-	inc	de
-	inc	de
-	dec	c
-	jr	nz,1b
 
+	ld	hl,(slot)
 	ld	a,(hl)
-	ld	(_grid_nr),a
+	cp	'S'		; game saved in this slot?
+	jr	nz,2b
+				;load data
+	ld	de,_packed
+	ld	bc,SLOT
+	ldir
 
 	ret
 ;
 _SaveGame:
-savegame:
-	ld	de,GameNrMsg	; Ask 'game nr'
-	call	show_string_de
-
-        ld	c,1             ; Accept response
-	call	BDOS
-
-	cp	'0'
-	jr	nc,2f
-1:
-	ld	de,WrongNumber
-	call	show_string_de
-	jr	savegame
-2:
-	cp	'9'+1
-	jr	nc,1b
-
-	ld	(fname+10),a	; Store game # as final ext char
+	call	askgame
 				; store game info
 	ld	de,SaveMsg
 	call	show_string_de
 
-	ld	de,fcb		; delete file (if any...)
-	ld	c,19
+	ld	de,fcb		; open file
+	ld	c,15
 	call	BDOS
+	inc	a
+	jr	nz,1f
 
-	ld	de,fcb		; make file
+	ld	de,fcb		; not found, make file
 	ld	c,22
 	call	BDOS
-
 	inc	a
-	jr	nz,1f
+	jr	nz,2f
 
 	ld	de,CannotWrite	; disk directory full
 	call	show_string_de
 	EXIT			; quit
 1:
-	xor	a		; prepare fcb
-	ld	(fcbcr),a
-
-	ld	de,buf		; set DMA addr
-	ld	c,26
+	ld	de,fcb		; read record (may hold the other game)
+	ld	c,33
 	call	BDOS
-				;save data
-	ld	de,buf
-	ld	hl,_grid
-	ld	c,81		;9x9
-1:
-	ld	a,(hl)
-	ld	(de),a
-	inc	hl
-	inc	hl
-	inc	de
-	dec	c
-	jr	nz,1b
-
-	ld	a,(_grid_nr)
-	ld	(de),a
-
-	ld	de,fcb		; write record		
-	ld	c,21
+	or	a
+	jr	z,3f
+2:
+	ld	hl,buf		; new record, fill-it with zeros
+	ld	de,buf+1
+	ld	bc,127
+	ld	(hl),0
+	ldir
+3:				;save data
+	ld	hl,_packed
+	ld	de,(slot)
+	ld	bc,SLOT
+	ldir
+
+	ld	de,fcb		; write record
+	ld	c,34
 	call	BDOS
 	or	a
 	jr	z,1f
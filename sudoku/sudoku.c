@@ -5,26 +5,56 @@
 
 #define Z80ALL
 
+//uncomment (with Z80ALL) to write straight to the VGA screen,
+//else the screen is written through the BIOS
+//#define VGA
+
 #ifdef Z80ALL
 #include "rtclib.h"
 #endif
 
+#ifdef VGA
+#include "vga.h"
+#undef putchar
+#define putchar(c)	VPutc(c)
+#define printf(s)	VPuts(s)	// the numbers are formatted by sprintf
+#else
+#define VSync()			// the BIOS cursor is already there
+#endif
+
 #define bool char
 #define TRUE 1
 #define FALSE 0
 
 #define N 9
 
+#define GENERATED 3	// grid_nr of a generated grid
+
+#define VALUE 0x0F	// grid cell: digit, 0 means unassigned
+#define GIVEN 0x10	// grid cell: digit is part of the puzzle
+
+// packed game, as stored in the save file
+#define SLOT 64
+#define PK_NR 1		// grid_nr
+#define PK_CELLS 2	// 81 digits, 2 per byte (low nibble first)
+#define PK_GIVEN 43	// 81 GIVEN flags, 8 per byte (low bit first)
+#define PK_VERSION 54	// save format
+#define VERSION 1	// this save format
+
+#define EASY 1		// naked singles are enough
+#define MEDIUM 2	// hidden singles needed
+#define HARD 3		// guessing needed
+
 #define ESCAPE 0x1B
 #define CR 0x0D
 #define CTRL_C 0x03
 #define CTRL_S 0x13
 
-// 0 means unassigned cells
 char grid_nr;
-int grid[N][N];
-int save[N][N];
-int GRID[3][N][N] = 
+char grid[N][N];
+char save[N][N];
+char packed[SLOT];
+char GRID[3][N][N] = 
 {
 {
 { 3, 0, 6, 5, 0, 8, 4, 0, 0 },
@@ -112,8 +142,13 @@ char picture[] = //Y,X,char
 13,1,'1',13,2,'2',13,3,'3',13,5,'4',13,6,'5',13,7,'6',13,9,'7',13,10,'8',13,11,'9',
 -1};
 
+char *levelName[] = { "", "easy", "medium", "hard" };
+
+char line[80];		// formatted messages
+
 void LoadGame(void);
 void SaveGame(void);
+bool full_grid(void);
 
 // --------------------------------------------------------------
 // Algorithm by Pradeep Mondal
@@ -123,11 +158,11 @@ bool isSafe(int row, int col, int num)
 	int i,j,x,startRow,startCol;
 	
 	for (x = 0; x <= 8; x++)
-		if (grid[row][x] == num)
+		if ((grid[row][x] & VALUE) == num)
 			return FALSE;
 
 	for (x = 0; x <= 8; x++)
-		if (grid[x][col] == num)
+		if ((grid[x][col] & VALUE) == num)
 			return FALSE;
 
 	startRow = row - row % 3;
@@ -135,60 +170,441 @@ bool isSafe(int row, int col, int num)
 
 	for (i = 0; i < 3; i++)
 		for (j = 0; j < 3; j++)
-			if (grid[i + startRow][j + startCol] == num)
+			if ((grid[i + startRow][j + startCol] & VALUE) == num)
 				return FALSE;
 
 	return TRUE;
 }
 
-bool solveSudoku(int row, int col)
+// --------------------------------------------------------------
+// Bitmask solver
+//
+// For each row, column and 3x3 box, bit (num-1) set = num already used.
+// Cells left with a single candidate are filled-in first (naked singles),
+// then the search branches on the empty cell with the fewest candidates.
+
+unsigned int rowMask[N], colMask[N], boxMask[N];
+char boxOf[N][N];
+char bitCount[512];	// number of bits set in a 9-bit mask
+char trail[N*N];	// naked singles filled-in, as row*N+col
+char ntrail;
+char nsol;		// solutions found
+char limit;		// stop after this many solutions
+bool shuffle;		// try the candidates in random order
+
+void xrndseed(void);
+unsigned int xrnd(void);
+
+void init_solver(void)
+{
+	int i, j;
+
+	for (i = 1; i < 512; i++)
+		bitCount[i] = (i & 1) + bitCount[i >> 1];
+
+	for (i = 0; i < N; i++)
+		for (j = 0; j < N; j++)
+			boxOf[i][j] = (i / 3) * 3 + j / 3;
+}
+
+void set_cell(int row, int col, int num)
 {
-	int num;
-	
-	if (row == N - 1 && col == N)
-		return 1;
+	unsigned int bit;
+
+	bit = 1 << (num - 1);
+	grid[row][col] = num;
+	rowMask[row] |= bit;
+	colMask[col] |= bit;
+	boxMask[boxOf[row][col]] |= bit;
+}
+
+void clear_cell(int row, int col)
+{
+	unsigned int bit;
+
+	bit = ~(1 << ((grid[row][col] & VALUE) - 1));
+	grid[row][col] = 0;
+	rowMask[row] &= bit;
+	colMask[col] &= bit;
+	boxMask[boxOf[row][col]] &= bit;
+}
+
+// Build the masks from grid
+// returns FALSE if a digit is repeated
+bool init_masks(void)
+{
+	int i, j, num;
+	unsigned int bit;
+
+	for (i = 0; i < N; i++)
+		rowMask[i] = colMask[i] = boxMask[i] = 0;
 
-	if (col == N)
+	for (i = 0; i < N; i++)
+		for (j = 0; j < N; j++)
+		{
+			num = grid[i][j] & VALUE;
+
+			if (num == 0)
+				continue;
+
+			bit = 1 << (num - 1);
+
+			if ((rowMask[i] | colMask[j] | boxMask[boxOf[i][j]]) & bit)
+				return FALSE;
+
+			rowMask[i] |= bit;
+			colMask[j] |= bit;
+			boxMask[boxOf[i][j]] |= bit;
+		}
+
+	return TRUE;
+}
+
+// Remove the naked singles filled-in since trail[start]
+void undo(char start)
+{
+	char cell;
+
+	while (ntrail > start)
 	{
-		row++;
-		col = 0;
+		cell = trail[--ntrail];
+		clear_cell(cell / N, cell % N);
 	}
+}
 
-	if (grid[row][col] > 0)
-		return solveSudoku(row, col + 1);
+// Returns TRUE when limit solutions were found
+// (grid holds the last one), else FALSE with grid restored
+bool solve(void)
+{
+	int row, col, num, best_row, best_col;
+	unsigned int free, best_free;
+	char count, best, start, first, i;
+	bool single;
 
-	for (num = 1; num <= N; num++)
+	start = ntrail;
+
+	do
+	{
+		single = FALSE;
+		best = N + 1;
+
+		for (row = 0; row < N; row++)
+			for (col = 0; col < N; col++)
+			{
+				if (grid[row][col])
+					continue;
+
+				free = ~(rowMask[row] | colMask[col] | boxMask[boxOf[row][col]]) & 0x1FF;
+				count = bitCount[free];
+
+				if (count == 0)
+				{
+					undo(start);
+					return FALSE;
+				}
+
+				if (count == 1)
+				{
+					for (num = 1; !(free & 1); num++)
+						free >>= 1;
+
+					set_cell(row, col, num);
+					trail[ntrail++] = row * N + col;
+					single = TRUE;
+				}
+				else if (count < best)
+				{
+					best = count;
+					best_row = row;
+					best_col = col;
+					best_free = free;
+				}
+			}
+	}
+	while (single);
+
+	if (best == N + 1)
 	{
-		if (isSafe(row, col, num))
+		// no empty cell left
+		if (++nsol >= limit)
+			return TRUE;
+
+		undo(start);
+		return FALSE;
+	}
+
+	first = shuffle ? xrnd() % N : 0;
+
+	for (i = 0; i < N; i++)
+	{
+		num = (first + i) % N + 1;
+
+		if (best_free & (1 << (num - 1)))
 		{
-			grid[row][col] = num;
+			set_cell(best_row, best_col, num);
 
-			if (solveSudoku(row, col + 1))
+			if (solve())
 				return TRUE;
+
+			clear_cell(best_row, best_col);
 		}
-	
-		grid[row][col] = 0;
 	}
+
+	undo(start);
 	return FALSE;
 }
 
+// Solve grid in place
+// returns FALSE if there is no solution (grid is left unchanged)
+bool solveSudoku(void)
+{
+	ntrail = 0;
+	nsol = 0;
+	limit = 1;
+
+	if (!init_masks())
+		return FALSE;
+
+	return solve();
+}
+
 // --------------------------------------------------------------
+// Generator & grading
 
-void xrndseed(void);
-unsigned int xrnd(void);
+char work[N][N];
+
+// Returns the number of solutions of grid, counting stops at 2
+char countSolutions(void)
+{
+	int i, j;
+
+	for (i = 0; i < N; i++)
+		for (j = 0; j < N; j++)
+			work[i][j] = grid[i][j];
+
+	ntrail = 0;
+	nsol = 0;
+	limit = 2;
+
+	if (init_masks())
+		solve();
+
+	for (i = 0; i < N; i++)
+		for (j = 0; j < N; j++)
+			grid[i][j] = work[i][j];
+
+	return nsol;
+}
+
+unsigned int candidates(int row, int col)
+{
+	return ~(rowMask[row] | colMask[col] | boxMask[boxOf[row][col]]) & 0x1FF;
+}
+
+// Fill-in the naked singles
+// returns 0 = none found, 1 = some found, -1 = a cell has no candidate
+char naked_singles(void)
+{
+	int row, col, num;
+	unsigned int free;
+	char found;
+
+	found = 0;
+
+	for (row = 0; row < N; row++)
+		for (col = 0; col < N; col++)
+		{
+			if (grid[row][col])
+				continue;
+
+			free = candidates(row, col);
+
+			if (free == 0)
+				return -1;
+
+			if (bitCount[free] == 1)
+			{
+				for (num = 1; !(free & 1); num++)
+					free >>= 1;
+
+				set_cell(row, col, num);
+				trail[ntrail++] = row * N + col;
+				found = 1;
+			}
+		}
+
+	return found;
+}
+
+// Fill-in the first hidden single found
+// (a digit that fits in only one cell of a row, column or box)
+// unit 0...8 = rows, 9...17 = columns, 18...26 = boxes
+bool hidden_single(void)
+{
+	int u, k, num, row, col, r, c, cnt;
+	unsigned int bit, used;
+
+	for (u = 0; u < 3 * N; u++)
+	{
+		if (u < N)
+			used = rowMask[u];
+		else if (u < 2 * N)
+			used = colMask[u - N];
+		else
+			used = boxMask[u - 2 * N];
+
+		for (num = 1; num <= N; num++)
+		{
+			bit = 1 << (num - 1);
+
+			if (used & bit)
+				continue;
+
+			cnt = 0;
+
+			for (k = 0; k < N; k++)
+			{
+				if (u < N)
+				{
+					r = u;
+					c = k;
+				}
+				else if (u < 2 * N)
+				{
+					r = k;
+					c = u - N;
+				}
+				else
+				{
+					r = ((u - 2 * N) / 3) * 3 + k / 3;
+					c = ((u - 2 * N) % 3) * 3 + k % 3;
+				}
+
+				if (!grid[r][c] && (candidates(r, c) & bit))
+				{
+					cnt++;
+					row = r;
+					col = c;
+				}
+			}
+
+			if (cnt == 1)
+			{
+				set_cell(row, col, num);
+				trail[ntrail++] = row * N + col;
+				return TRUE;
+			}
+		}
+	}
+
+	return FALSE;
+}
+
+// Returns the techniques needed to solve grid (EASY, MEDIUM or HARD)
+// grid is left unchanged
+char grade(void)
+{
+	char level, found;
+
+	level = EASY;
+	ntrail = 0;
+
+	if (!init_masks())
+		return HARD;
+
+	while (!full_grid())
+	{
+		found = naked_singles();
+
+		if (found < 0)
+		{
+			level = HARD;
+			break;
+		}
+
+		if (found)
+			continue;
+
+		if (hidden_single())
+		{
+			level = MEDIUM;
+			continue;
+		}
+
+		level = HARD;
+		break;
+	}
+
+	undo(0);
+	return level;
+}
+
+// Build a random full grid, then remove the digits in random order,
+// keeping each removal only if the grid still has a single solution
+// and needs no harder techniques than level
+// (a grid solved by singles alone has a single solution)
+void generate(char level)
+{
+	char cells[N*N];
+	int i, j, t, row, col, num;
+
+	for (i = 0; i < N; i++)
+		for (j = 0; j < N; j++)
+			grid[i][j] = 0;
+
+	shuffle = TRUE;
+	solveSudoku();
+	shuffle = FALSE;
+
+	for (i = 0; i < N*N; i++)
+		cells[i] = i;
+
+	for (i = N*N - 1; i > 0; i--)
+	{
+		j = xrnd() % (i + 1);
+		t = cells[i];
+		cells[i] = cells[j];
+		cells[j] = t;
+	}
+
+	for (i = 0; i < N*N; i++)
+	{
+		row = cells[i] / N;
+		col = cells[i] % N;
+		num = grid[row][col];
+		grid[row][col] = 0;
+
+		if (level < HARD ? grade() > level : countSolutions() != 1)
+			grid[row][col] = num;
+	}
+
+	for (i = 0; i < N; i++)
+		for (j = 0; j < N; j++)
+			if (grid[i][j])
+				grid[i][j] |= GIVEN;
+}
+
+// --------------------------------------------------------------
 
 void clear(void)
 {
+#ifdef VGA
+    VClear();
+#else
 #ifdef Z80ALL
     putchar( ESCAPE ); putchar( 'H' );	//home
     putchar( ESCAPE ); putchar( 'J' );	//erase to end-of-screen
 #else
 printf("%c[2J%c[H",27,27);
 #endif
+#endif
 }
 
 void gotoxy(int y,int x)
 {
+#ifdef VGA
+    VLocate(y, x);
+#else
 #ifdef Z80ALL
     putchar( ESCAPE ); putchar( 'Y' );
     putchar( 31+y+1 );
@@ -196,6 +612,7 @@ void gotoxy(int y,int x)
 #else
 printf("%c[%d;%dH",27,y+1,x+1);
 #endif
+#endif
 }
 
 void print_picture(void)
@@ -219,7 +636,7 @@ void print_grid(void)
 			if (grid[x][y])
 			{
 				gotoxy(y+1+(y/3), x+1+(x/3));
-				putchar(grid[x][y]+'0');
+				putchar((grid[x][y] & VALUE) + '0');
 			}
 }
 
@@ -229,7 +646,12 @@ void init_grid(int n)
 
 	for (x = 0; x < N; x++)
 		for (y = 0; y < N; y++)
+		{
 			grid[x][y] = GRID[n][x][y];
+
+			if (grid[x][y])
+				grid[x][y] |= GIVEN;
+		}
 }
 
 bool full_grid(void)
@@ -244,16 +666,115 @@ bool full_grid(void)
 	return TRUE;
 }
 
+// Pack grid & grid_nr to the save slot
+void pack_game(void)
+{
+	char *p;
+	int k;
+
+	p = &grid[0][0];
+
+	for (k = 0; k < SLOT; k++)
+		packed[k] = 0;
+
+	packed[0] = 'S';	// slot used
+	packed[PK_NR] = grid_nr;
+	packed[PK_VERSION] = VERSION;
+
+	for (k = 0; k < N*N; k++)
+	{
+		if (k & 1)
+			packed[PK_CELLS + k / 2] |= (p[k] & VALUE) << 4;
+		else
+			packed[PK_CELLS + k / 2] |= p[k] & VALUE;
+
+		if (p[k] & GIVEN)
+			packed[PK_GIVEN + k / 8] |= 1 << (k & 7);
+	}
+}
+
+// Unpack grid & grid_nr from the save slot
+void unpack_game(void)
+{
+	char *p;
+	int k;
+
+	p = &grid[0][0];
+	grid_nr = packed[PK_NR];
+
+	for (k = 0; k < N*N; k++)
+	{
+		if (k & 1)
+			p[k] = (packed[PK_CELLS + k / 2] >> 4) & VALUE;
+		else
+			p[k] = packed[PK_CELLS + k / 2] & VALUE;
+
+		if (packed[PK_GIVEN + k / 8] & (1 << (k & 7)))
+			p[k] |= GIVEN;
+	}
+}
+
+void save_game(void)
+{
+	pack_game();
+	VSync();
+	SaveGame();	// does not return
+}
+
+#ifdef Z80ALL
+#define RUNS 10
+
+// Returns the time of day, in seconds
+long seconds(void)
+{
+	long t;
+
+	t = GetTime();
+
+	return ((t >> 16) & 0xFF) * 3600L + ((t >> 8) & 0xFF) * 60L + (t & 0xFF);
+}
+
+// Solve RUNS times each built-in grid, print the time taken
+void time_solver(void)
+{
+	int n, r;
+	long t;
+
+	printf("\r\n");
+
+	for (n = 0; n < 3; n++)
+	{
+		t = seconds();
+
+		for (r = 0; r < RUNS; r++)
+		{
+			init_grid(n);
+			solveSudoku();
+		}
+
+		t = seconds() - t;
+
+		if (t < 0)
+			t += 86400L;	// past midnight
+
+		sprintf(line, "Grid #%d solved %d times in %ld seconds\r\n", n, RUNS, t);
+		printf(line);
+	}
+}
+#endif
+
 void show(void)
 {
-	solveSudoku(0, 0);
+	solveSudoku();
 	print_grid();
 	gotoxy(22,0);
 #ifdef Z80ALL
 	GetStopTime();
 	printf("\r\nGame duration: ");
+	VSync();
 	PrintLapseTime();
 #endif
+	VSync();
 	exit(1);
 }
 
@@ -263,6 +784,7 @@ void main(void)
 	int i,j;
 	
 	xrndseed();
+	init_solver();
 	clear();
 	print_picture();
 
@@ -272,14 +794,37 @@ void main(void)
 	       "column, each row, and each of the nine 3x3 subgrids that\r\n"
 	       "compose the grid contain all of the digits from 1 to 9.\r\n");
 
+#ifdef Z80ALL
+	printf("Load a saved game (Y/y=yes, T/t=time the solver)? :");
+#else
 	printf("Load a saved game (Y/y=yes)? :");
+#endif
 
 	v = getch();
 	putchar(v);
 
+#ifdef Z80ALL
+	if (v == 't' || v == 'T')
+	{
+		time_solver();
+		VSync();
+		exit(1);
+	}
+#endif
+
 	if (v == 'y' || v == 'Y')
 	{
+		VSync();
 		LoadGame();
+
+		if (packed[PK_VERSION] != VERSION)
+		{
+			printf("\r\nThis game was saved in another format!");
+			VSync();
+			exit(1);
+		}
+
+		unpack_game();
 		clear();
 		print_picture();
 	}
@@ -287,11 +832,36 @@ void main(void)
 	{
 		printf("\r\nYou will start with a grid already containing some digits,\r\n"
 	       		"fit to be successfully completed...\r\n"
-	       		"Choose a grid# from 0 to 2 or <CR> to pick a random # :");
+	       		"Choose a grid# from 0 to 2, <CR> to pick a random #\r\n"
+	       		"or G to generate a new grid :");
 choose:
 		grid_nr = getch();
 
-		if (grid_nr == CR)
+		if (grid_nr == 'g' || grid_nr == 'G')
+		{
+			putchar(grid_nr);
+			printf("\r\nDifficulty (1=easy, 2=medium, 3=hard) :");
+
+			do
+				v = getch();
+			while (v < '0' + EASY || v > '0' + HARD);
+
+			putchar(v);
+			printf("\r\nGenerating...");
+
+			// retry a few times if the grid came out easier
+			i = 0;
+
+			do
+				generate(v - '0');
+			while (grade() < v - '0' && ++i < 4);
+
+			grid_nr = GENERATED;
+
+			clear();
+			print_picture();
+		}
+		else if (grid_nr == CR)
 		{
 			grid_nr = xrnd() % 3;
 			putchar(grid_nr + '0');
@@ -305,9 +875,12 @@ choose:
 			grid_nr -= '0';
 		}
 
-		clear();
-		print_picture();
-		init_grid(grid_nr);
+		if (grid_nr != GENERATED)
+		{
+			clear();
+			print_picture();
+			init_grid(grid_nr);
+		}
 	}
 
 #ifdef Z80ALL
@@ -318,8 +891,16 @@ choose:
 	print_grid();
 
 	gotoxy(15,0);
-	printf("Grid #%d: fill in the missing digits...\r\n"
-		"(CTRL^C to see the solution & quit, CTRL^S to save game)", grid_nr);
+
+	if (grid_nr == GENERATED)
+		sprintf(line, "Generated grid (%s)", levelName[grade()]);
+	else
+		sprintf(line, "Grid #%d", grid_nr);
+
+	printf(line);
+
+	printf(": fill in the missing digits...\r\n"
+		"(CTRL^C to see the solution & quit, CTRL^S to save game)");
 
 	while (TRUE)
 	{
@@ -339,7 +920,7 @@ choose:
 				show();
 
 			if (y == CTRL_S)
-				SaveGame();
+				save_game();
 		}
 		while (!isdigit(y) || y == '0');
 
@@ -356,8 +937,8 @@ choose:
 			if (x == CTRL_C)
 				show();
 
-			if (y == CTRL_S)
-				SaveGame();
+			if (x == CTRL_S)
+				save_game();
 		}
 		while (!isdigit(x) || x == '0');
 
@@ -381,8 +962,8 @@ choose:
 			if (v == CTRL_C) 
 				show();
 
-			if (y == CTRL_S)
-				SaveGame();
+			if (v == CTRL_S)
+				save_game();
 		}
 		while (!isdigit(v) || v == '0');
 
@@ -401,7 +982,7 @@ choose:
 			for (j=0; j<N; j++)
 				save[i][j] = grid[i][j];
 
-		solveSudoku(0, 0);
+		solveSudoku();
 		hint = grid[x][y];
 
 		for (i=0; i<N; i++)
@@ -410,7 +991,8 @@ choose:
 
 		if (v != hint)
 		{
-			printf(" Bad choice! Try instead %d!(hit any key...)", hint);
+			sprintf(line, " Bad choice! Try instead %d!(hit any key...)", hint);
+			printf(line);
 			getch();
 			continue;
 		}
@@ -428,8 +1010,10 @@ choose:
 #ifdef Z80ALL
 				GetStopTime();
 				printf("\r\nGame duration: ");
+				VSync();
 				PrintLapseTime();
 #endif
+				VSync();
 				exit(1);
 			}
 		}
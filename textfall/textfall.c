@@ -13,10 +13,20 @@
 //uncomment for VT52/Z80ALL, else it will be VT100 compatible
 //#define Z80ALL
 
+//uncomment (with Z80ALL) to write straight to the VGA screen,
+//else the screen is written through the BIOS
+//#define VGA
+
 #ifdef Z80ALL
 #include "rtclib.h"
 #endif
 
+#ifdef VGA
+#include "vga.h"
+#else
+#define VSync()			// the BIOS cursor is already there
+#endif
+
 #define bool char
 #define TRUE 1
 #define FALSE 0
@@ -69,6 +79,7 @@ char* Spoon = "\\_/";
 char* Text="the quick brown fox jumps over the lazy dog";
 char* Help="s=slower f=faster l=less m=more ^C=quit space=pause";
 char intbuf[6];
+char line[80];		// formatted messages
 
 char screen[COLS][ROWS];
 
@@ -94,16 +105,23 @@ char *itoa(int i)
 
 void clear(void)
 {
+#ifdef VGA
+    VClear();
+#else
 #ifdef Z80ALL
     CrtOut( ESCAPE ); CrtOut( 'H' );	//home
     CrtOut( ESCAPE ); CrtOut( 'J' );	//erase to end-of-screen
 #else
     putstr("\x1B[2J\x1B[H");
 #endif
+#endif
 }
 
 void gotoxy(int x, int y)
 {
+#ifdef VGA
+    VLocate(y, x);
+#else
 #ifdef Z80ALL
     CrtOut( ESCAPE ); CrtOut( 'Y' );
     CrtOut( 31+y+1 );
@@ -117,15 +135,20 @@ void gotoxy(int x, int y)
     CrtOut( 'H' );
 	//putstr("%c[%d;%dH",27,y+1,x+1);
 #endif
+#endif
 }
 
 void eraseToEOL(void)
 {
+#ifdef VGA
+    VClearEOL();
+#else
 #ifdef Z80ALL
     CrtOut( ESCAPE ); CrtOut( 'K' );
 #else
     putstr("\x1B[K");
 #endif
+#endif
 }
 
 #ifdef Z80ALL
@@ -150,6 +173,13 @@ void	CursorON(void)
 	putstr(cON);
 }
 
+#ifdef VGA
+// from here on, the text goes straight to the screen
+// (the cursor is still shown/hidden by the BIOS)
+#define CrtOut(c)	VPutc(c)
+#define putstr(s)	VPuts(s)
+#endif
+
 
 #define K_LEFT	1
 #define K_RIGHT	2
@@ -409,6 +439,7 @@ void get_key_and_do_action(void)
 		switch (c)
 		{
 			case CTRL_C:	
+					VSync();
 					CursorON();
 					exit();
 			case K_LEFT:
@@ -563,11 +594,14 @@ void main(void)
 				clear();
 				CursorON();
 				gotoxy(0, 0);
-				printf("Letters dropped: %d catched: %d missed: %d", dropped, catched, missed);
+				sprintf(line, "Letters dropped: %d catched: %d missed: %d", dropped, catched, missed);
+				putstr(line);
 #ifdef Z80ALL
-				printf("\r\nGame duration: ");
+				putstr("\r\nGame duration: ");
+				VSync();
 				PrintLapseTime();
 #endif
+				VSync();
 				exit();
 			}
 		}